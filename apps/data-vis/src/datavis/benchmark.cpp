@@ -0,0 +1,1376 @@
+#include "precomp.h"
+
+namespace DataVis
+{
+namespace Benchmark
+{
+namespace
+{
+    // The all pairs segment test GraphQualityMetrics::Crossings replaced
+    std::pair<int, float> EdgeCrossingsReference(const VectorOfEdgePaths& _edges)
+    {
+        int crossings = 0;
+        float min_angle = MAX_FLOAT;
+        for (size_t i = 0; i + 1 < _edges.size(); i++)
+        {
+            for (size_t j = i + 1; j < _edges.size(); j++)
+            {
+                const auto& edge_1 = _edges[i]->points;
+                const auto& edge_2 = _edges[j]->points;
+                for (size_t k1 = 0; k1 + 1 < edge_1.size(); k1++)
+                {
+                    for (size_t k2 = 0; k2 + 1 < edge_2.size(); k2++)
+                    {
+                        const auto& p1 = edge_1[k1].new_value;
+                        const auto& p2 = edge_1[k1 + 1].new_value;
+                        const auto& q1 = edge_2[k2].new_value;
+                        const auto& q2 = edge_2[k2 + 1].new_value;
+                        if ((((q1.x - p1.x) * (p2.y - p1.y) - (q1.y - p1.y) * (p2.x - p1.x))
+                            * ((q2.x - p1.x) * (p2.y - p1.y) - (q2.y - p1.y) * (p2.x - p1.x)) < 0)
+                            &&
+                            (((p1.x - q1.x) * (q2.y - q1.y) - (p1.y - q1.y) * (q2.x - q1.x))
+                                * ((p2.x - q1.x) * (q2.y - q1.y) - (p2.y - q1.y) * (q2.x - q1.x)) < 0))
+                        {
+                            crossings++;
+                            const glm::vec3 p = glm::normalize(p2 - p1);
+                            const glm::vec3 q = glm::normalize(q2 - q1);
+                            min_angle = std::min(min_angle, std::acos(glm::dot(p, q)));
+                        }
+                    }
+                }
+            }
+        }
+        return { crossings, min_angle };
+    }
+    // Equal counts, the angles may differ in the last bits when acos is evaluated in double on one side
+    bool SameCrossings(const std::pair<int, float>& _a, const std::pair<int, float>& _b)
+    {
+        return _a.first == _b.first && std::abs(_a.second - _b.second) <= 1e-5f;
+    }
+} // namespace
+
+//--------------------------------------------------------------
+// Self Checks
+//--------------------------------------------------------------
+bool CrossingMetricCheck(uint _seed)
+{
+    std::mt19937 rng(_seed);
+    std::uniform_real_distribution<float> coordinate(0, 800);
+    std::uniform_real_distribution<float> offset(-20, 20);
+    std::uniform_int_distribution<int> lattice(0, 40);
+    // Long segments span many cells, short ones few, lattice points give shared end points, touching and collinear
+    // segments, and axis aligned ones with a flat bounding box
+    const std::function<glm::vec3(const glm::vec3&)> layouts[] = {
+        [&](const glm::vec3&) { return glm::vec3(coordinate(rng), coordinate(rng), 0); },
+        [&](const glm::vec3& _p) { return _p + glm::vec3(offset(rng), offset(rng), 0); },
+        [&](const glm::vec3&) { return glm::vec3(lattice(rng) * 20, lattice(rng) * 20, 0); },
+    };
+    const char* names[] = { "long", "short", "lattice" };
+
+    bool identical = true;
+    for (int l = 0; l < IM_ARRAYSIZE(layouts); l++)
+    {
+        for (const int edge_count : { 2, 10, 100, 1000, 3000 })
+        {
+            // Straight edges, every fourth one bent once
+            VectorOfEdgePaths edges;
+            for (int e = 0; e < edge_count; e++)
+            {
+                auto edge = std::make_shared<EdgePath>(e, Dataset::Kind::Undirected);
+                glm::vec3 p = layouts[l](glm::vec3(coordinate(rng), coordinate(rng), 0));
+                edge->AddPoint(p);
+                for (int k = e % 4 == 0 ? 2 : 1; k > 0; k--)
+                {
+                    p = layouts[l](p);
+                    edge->AddPoint(p);
+                }
+                edges.push_back(edge);
+            }
+            const auto reference = EdgeCrossingsReference(edges);
+            const auto grid = GraphQualityMetrics::Crossings(edges);
+            if (SameCrossings(grid, reference)) continue;
+            identical = false;
+            std::cout << "Crossing metric check, seed " << _seed << ", " << names[l] << " layout, " << edge_count << " edges: grid "
+                << grid.first << " crossings, min angle " << grid.second << ", reference " << reference.first << " crossings, min angle "
+                << reference.second << std::endl;
+        }
+    }
+    return identical;
+}
+} // namespace Benchmark
+} // namespace DataVis
+
+#ifdef DATAVIS_BENCHMARKS
+
+namespace DataVis
+{
+namespace Benchmark
+{
+namespace
+{
+    bool SameVertices(const Dataset& _a, const Dataset& _b)
+    {
+        if (_a.vertices.size() != _b.vertices.size() || _a.edges.size() != _b.edges.size()) return false;
+        for (size_t i = 0; i < _a.vertices.size(); i++)
+        {
+            const auto& v = *_a.vertices[i];
+            const auto& u = *_b.vertices[i];
+            if (v.id != u.id || v.idx != u.idx || v.owner != u.owner || v.attributes.map != u.attributes.map) return false;
+        }
+        for (size_t i = 0; i < _a.edges.size(); i++)
+        {
+            const auto& e = _a.edges[i];
+            const auto& f = _b.edges[i];
+            if (e.from_idx != f.from_idx || e.to_idx != f.to_idx || e.attributes.map != f.attributes.map) return false;
+        }
+        return true;
+    }
+
+    bool SameAdjacency(const Adjacency& _a, const Adjacency& _b)
+    {
+        if (_a.Size() != _b.Size()) return false;
+        auto same = [](const Adjacency::Neighbors& _x, const Adjacency::Neighbors& _y)
+        {
+            if (_x.size() != _y.size()) return false;
+            for (int i = 0; i < _x.size(); i++)
+                if (_x[i].idx != _y[i].idx || _x[i].edge_idx != _y[i].edge_idx) return false;
+            return true;
+        };
+        for (size_t v = 0; v < _a.Size(); v++)
+            if (!same(_a.Outgoing(v), _b.Outgoing(v)) || !same(_a.Incoming(v), _b.Incoming(v))) return false;
+        return true;
+    }
+
+    bool SameDataset(const Dataset& _a, const Dataset& _b)
+    {
+        if (!SameVertices(_a, _b) || !SameAdjacency(_a.GetAdjacency(), _b.GetAdjacency())) return false;
+        const auto* a = dynamic_cast<const ClusterDataset*>(&_a);
+        const auto* b = dynamic_cast<const ClusterDataset*>(&_b);
+        if (!a || !b) return !a && !b;
+        if (a->clusters.size() != b->clusters.size()) return false;
+        for (size_t i = 0; i < a->clusters.size(); i++)
+            if (!SameVertices(*a->clusters[i], *b->clusters[i]) || !SameAdjacency(a->clusters[i]->GetAdjacency(), b->clusters[i]->GetAdjacency()))
+                return false;
+        return true;
+    }
+
+    // Finishes the animations, so the positions and the bounds are final
+    void Settle(IStructure& _structure)
+    {
+        for (int frame = 0; frame < 60; frame++)
+            _structure.Update(1 / 30.f);
+    }
+
+    // The crossing counter SugiyamaLayout used before the accumulator tree, O(E^2) per pair of layers
+    int CrossingsReference(const Adjacency& _adjacency, const SugiyamaLayout::Layer& _layer_1, const SugiyamaLayout::Layer& _layer_2)
+    {
+        std::vector<bool> flags;
+        std::vector<std::pair<int, int>> open_edges;
+        int count = 0;
+        for (const int vertex_idx : _layer_1)
+            for (const Neighbor n : _adjacency.Outgoing(vertex_idx))
+                open_edges.emplace_back(vertex_idx, n.idx);
+        flags.resize(open_edges.size(), false);
+
+        for (int i = static_cast<int>(_layer_2.size()) - 1; i >= 0; i--)
+        {
+            const int vertex_idx = _layer_2[i];
+            for (const Neighbor n : _adjacency.Incoming(vertex_idx))
+            {
+                const std::pair<int, int> edge(n.idx, vertex_idx);
+                for (int j = static_cast<int>(open_edges.size()) - 1; j >= 0; j--)
+                {
+                    if (flags[j]) continue;
+                    if (open_edges[j] == edge)
+                    {
+                        flags[j] = true;
+                        break;
+                    }
+                    if (open_edges[j].first != edge.first && open_edges[j].second != edge.second)
+                        count++;
+                }
+            }
+        }
+        return count;
+    }
+
+    // SugiyamaLayout::BreakCycles before the bucket queues, O(V) per vertex it picks
+    void BreakCyclesReference(SugiyamaLayout::LayeredGraph& _graph)
+    {
+        const auto& adjacency = _graph.adjacency;
+        const int size = _graph.vertex_count;
+        std::vector<int> out_degree(size), in_degree(size);
+        for (int v = 0; v < size; v++)
+        {
+            out_degree[v] = adjacency.Outgoing(v).size();
+            in_degree[v] = adjacency.Incoming(v).size();
+        }
+
+        std::vector<bool> removed(size, false);
+        int remaining = size;
+        auto remove = [&](int _v)
+        {
+            removed[_v] = true;
+            remaining--;
+            for (const Neighbor n : adjacency.Outgoing(_v))
+                in_degree[n.idx]--;
+            for (const Neighbor n : adjacency.Incoming(_v))
+                out_degree[n.idx]--;
+        };
+
+        std::vector<int> stack;
+        while (remaining > 0)
+        {
+            // Remove sinks, their edges stay as they are. Removing a sink can turn its predecessors into sinks
+            for (int v = 0; v < size; v++)
+                if (!removed[v] && out_degree[v] == 0) stack.push_back(v);
+            while (!stack.empty())
+            {
+                const int v = stack.back();
+                stack.pop_back();
+                if (removed[v]) continue;
+                remove(v);
+                for (const Neighbor n : adjacency.Incoming(v))
+                    if (!removed[n.idx] && out_degree[n.idx] == 0) stack.push_back(n.idx);
+            }
+
+            // Remove sources, removing a source can turn its successors into sources
+            for (int v = 0; v < size; v++)
+                if (!removed[v] && in_degree[v] == 0) stack.push_back(v);
+            while (!stack.empty())
+            {
+                const int v = stack.back();
+                stack.pop_back();
+                if (removed[v]) continue;
+                remove(v);
+                for (const Neighbor n : adjacency.Outgoing(v))
+                    if (!removed[n.idx] && in_degree[n.idx] == 0) stack.push_back(n.idx);
+            }
+            if (remaining == 0) break;
+
+            // Remove the vertex with the most outgoing edges, its remaining incoming edges are reversed
+            int max_vertex_idx = -1;
+            int max_difference = INT_MIN;
+            for (int v = 0; v < size; v++)
+            {
+                if (removed[v]) continue;
+                const int difference = out_degree[v] - in_degree[v];
+                if (difference > max_difference)
+                {
+                    max_vertex_idx = v;
+                    max_difference = difference;
+                }
+            }
+            for (const Neighbor n : adjacency.Incoming(max_vertex_idx))
+            {
+                if (removed[n.idx]) continue;
+                std::swap(_graph.from[n.edge_idx], _graph.to[n.edge_idx]);
+                _graph.reversed[_graph.owner[n.edge_idx]] = true;
+            }
+            remove(max_vertex_idx);
+        }
+        _graph.BuildAdjacency();
+    }
+
+    // Random DAG on a random order of the vertices, with a fraction of the edges turned around to create cycles
+    SugiyamaLayout::LayeredGraph SyntheticGraph(int _vertex_count, int _edge_count, float _back_edges, std::mt19937& _rng)
+    {
+        SugiyamaLayout::LayeredGraph graph;
+        graph.dataset_vertex_count = graph.vertex_count = _vertex_count;
+        std::vector<int> order(_vertex_count);
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), _rng);
+        std::uniform_int_distribution<int> vertex(0, _vertex_count - 1);
+        std::uniform_real_distribution<float> fraction(0, 1);
+        while (static_cast<int>(graph.from.size()) < _edge_count)
+        {
+            int from = vertex(_rng), to = vertex(_rng);
+            if (from == to) continue;
+            if (from > to) std::swap(from, to);
+            if (fraction(_rng) < _back_edges) std::swap(from, to);
+            graph.owner.push_back(static_cast<EdgeIdx>(graph.from.size()));
+            graph.from.push_back(order[from]);
+            graph.to.push_back(order[to]);
+        }
+        graph.reversed.assign(graph.from.size(), false);
+        graph.BuildAdjacency();
+        return graph;
+    }
+
+    bool IsAcyclic(const SugiyamaLayout::LayeredGraph& _graph)
+    {
+        std::vector<SugiyamaLayout::Layer> vertices_per_layer;
+        SugiyamaLayout::Layer layer_per_vertex;
+        SugiyamaLayout::LayerAssignment(_graph, vertices_per_layer, layer_per_vertex);
+        size_t layered = 0;
+        for (const auto& layer : vertices_per_layer)
+            layered += layer.size();
+        return layered == static_cast<size_t>(_graph.vertex_count);
+    }
+
+    // SugiyamaLayout::VertexPositioning before the four alignments, one alignment from the top left
+    std::vector<float> VertexPositioningReference(const SugiyamaLayout::LayeredGraph& _graph,
+                                                  const std::vector<SugiyamaLayout::Layer>& _vertices_per_layer,
+                                                  const SugiyamaLayout::Layer& _layer_per_vertex, float _delta)
+    {
+        const int size = _graph.vertex_count;
+        std::vector<int> pos_per_vertex(size);
+        for (const auto& layer : _vertices_per_layer)
+            for (int i = 0; i < layer.size(); i++)
+                pos_per_vertex[layer[i]] = i;
+
+        // Vertical alignment
+        std::vector<int> root(size), align(size);
+        std::vector<Neighbor> neighbors;
+        for (int i = 0; i < size; i++)
+        {
+            root[i] = i;
+            align[i] = i;
+        }
+        for (const auto& layer : _vertices_per_layer)
+        {
+            int rank = -1;
+            for (const int vertex_idx : layer)
+            {
+                const auto outgoing = _graph.adjacency.Outgoing(vertex_idx);
+                const int d = outgoing.size();
+                if (d <= 0) continue;
+                const int ms[2] = { (d + 1) / 2, (d + 2) / 2 };
+                neighbors.assign(outgoing.begin(), outgoing.end());
+                std::sort(neighbors.begin(), neighbors.end(), [&](Neighbor lhs, Neighbor rhs)
+                {
+                    return pos_per_vertex[lhs.idx] < pos_per_vertex[rhs.idx];
+                });
+                for (const int m : ms)
+                {
+                    const int u_m = neighbors[m - 1].idx;
+                    if (align[vertex_idx] != vertex_idx || rank >= pos_per_vertex[u_m]) continue;
+                    align[u_m] = vertex_idx;
+                    root[vertex_idx] = root[u_m];
+                    align[vertex_idx] = root[vertex_idx];
+                    rank = pos_per_vertex[u_m];
+                }
+            }
+        }
+
+        // Horizontal compaction
+        constexpr float undefined = MIN_FLOAT;
+        constexpr float infinite = MAX_FLOAT;
+        std::vector<float> sink(size), shift(size, infinite), x_per_vertex(size, undefined);
+        for (int i = 0; i < size; i++)
+            sink[i] = i;
+        std::function<void(int)> place_block = [&](int v)
+        {
+            if (x_per_vertex[v] != undefined) return;
+            x_per_vertex[v] = 0;
+            int w = v;
+            do
+            {
+                const int w_pos = pos_per_vertex[w];
+                if (w_pos > 0)
+                {
+                    const int u = root[_vertices_per_layer[_layer_per_vertex[w]][w_pos - 1]];
+                    place_block(u);
+                    if (sink[v] == v) sink[v] = sink[u];
+                    if (sink[v] == sink[u])
+                        x_per_vertex[v] = std::max(x_per_vertex[v], x_per_vertex[u] + _delta);
+                }
+                w = align[w];
+            }
+            while (w != v);
+            while (align[w] != v)
+            {
+                w = align[w];
+                x_per_vertex[w] = x_per_vertex[v];
+                sink[w] = sink[v];
+            }
+        };
+        for (int vertex_idx = 0; vertex_idx < size; vertex_idx++)
+            if (root[vertex_idx] == vertex_idx) place_block(vertex_idx);
+
+        for (size_t i = 0; i < _vertices_per_layer.size(); i++)
+        {
+            const int v_1 = _vertices_per_layer[i][0];
+            if (sink[v_1] != v_1) continue;
+            if (shift[sink[v_1]] == infinite) shift[sink[v_1]] = 0;
+            int j = i;
+            int k = 0;
+            int v = undefined;
+            do
+            {
+                v = _vertices_per_layer[j][k];
+                while (align[v] != root[v])
+                {
+                    v = align[v];
+                    j--;
+                    if (pos_per_vertex[v] > 0)
+                    {
+                        const int u = _vertices_per_layer[_layer_per_vertex[v]][pos_per_vertex[v] - 1];
+                        shift[sink[u]] = std::min(shift[sink[u]], shift[sink[v]] + x_per_vertex[v] - (x_per_vertex[u] + _delta));
+                    }
+                }
+                k = pos_per_vertex[v] + 1;
+            }
+            while (k < _vertices_per_layer[j].size() && sink[v] == sink[_vertices_per_layer[j][k]]);
+        }
+        for (int i = 0; i < size; i++)
+            x_per_vertex[i] = x_per_vertex[i] + shift[sink[i]];
+        return x_per_vertex;
+    }
+
+    // Sum of the horizontal distance the edges of the layered graph cover, and how many run straight down
+    std::pair<float, int> EdgeSlant(const SugiyamaLayout::LayeredGraph& _graph, const std::vector<float>& _x_per_vertex)
+    {
+        float slant = 0;
+        int straight = 0;
+        for (size_t e = 0; e < _graph.from.size(); e++)
+        {
+            const float dx = std::abs(_x_per_vertex[_graph.to[e]] - _x_per_vertex[_graph.from[e]]);
+            slant += dx;
+            straight += dx < 1e-3f;
+        }
+        return { slant, straight };
+    }
+    // Trustworthiness and continuity with a full sort of the projected distances per vertex and a search for every rank.
+    // The projected neighbor test of continuity compared dists[j] instead of dists[k], the reference has it fixed
+    std::pair<float, float> TrustworthinessContinuityReference(IStructure& _structure, int _K)
+    {
+        auto& nodes = _structure.nodes;
+        const uint N = nodes.size();
+        const auto& dataset = *_structure.dataset;
+        const auto& v_i_K = *dataset.GetDistanceCache().GetNeighbors(dataset);
+
+        float trustworthiness = 0, continuity = 0;
+        for (int i = 0; i < nodes.size(); i++)
+        {
+            std::vector<std::pair<int, double>> dists;
+            for (int j = 0; j < nodes.size(); j++)
+            {
+                if (i == j) continue;
+                dists.emplace_back(j, glm::length(nodes[i]->GetNewPosition() - nodes[j]->GetNewPosition()));
+            }
+            std::sort(dists.begin(), dists.end(), [](std::pair<int, double> lhs, std::pair<int, double> rhs) {
+                return lhs.second < rhs.second;
+            });
+
+            for (int j = 0; j < _K; j++)
+            {
+                // False neighbors
+                bool original_neighbour = false;
+                for (int k = 0; k < _K; k++)
+                    original_neighbour |= v_i_K[i][k].first == dists[j].first;
+                if (!original_neighbour)
+                {
+                    for (int k = _K; k < v_i_K[i].size(); k++)
+                        if (v_i_K[i][k].first == dists[j].first)
+                            trustworthiness += k - _K;
+                }
+                // Missing neighbors
+                bool projected_neighbour = false;
+                for (int k = 0; k < _K; k++)
+                    projected_neighbour |= dists[k].first == v_i_K[i][j].first;
+                if (!projected_neighbour)
+                {
+                    for (int k = _K; k < dists.size(); k++)
+                        if (dists[k].first == v_i_K[i][j].first)
+                            continuity += k - _K;
+                }
+            }
+        }
+        const float scale = 2 / static_cast<float>(N * _K * (2 * N - 3 * _K - 1));
+        return { 1 - trustworthiness * scale, 1 - continuity * scale };
+    }
+
+    // Prim with a linear argmin over the costs, then a search over all vertices for the children of every node.
+    // Continues from the lowest unreached vertex like MSP::Prim, the original asserted instead
+    std::vector<VertexIdx> MinimumSpanningTreeReference(const Adjacency& _adjacency, const std::vector<float>& _weights, VertexIdx _root,
+                                                        std::vector<std::vector<VertexIdx>>& _children)
+    {
+        const int size = static_cast<int>(_adjacency.Size());
+        std::vector<VertexIdx> parents(size, _root);
+        parents[_root] = -1;
+        std::vector<bool> included(size, false);
+        std::vector<float> costs(size, MAX_FLOAT);
+        costs[_root] = 0;
+        for (int i = 0; i < size; i++)
+        {
+            float min = MAX_FLOAT;
+            int idx = -1;
+            for (int v = 0; v < size; v++)
+            {
+                if (!included[v] && costs[v] < min)
+                {
+                    min = costs[v];
+                    idx = v;
+                }
+            }
+            if (idx == -1)
+            {
+                idx = static_cast<int>(std::find(included.begin(), included.end(), false) - included.begin());
+                parents[idx] = _root;
+            }
+            included[idx] = true;
+            for (const Neighbor neighbor : _adjacency.Outgoing(idx))
+            {
+                const float weight = _weights[neighbor.edge_idx];
+                if (!included[neighbor.idx] && weight < costs[neighbor.idx])
+                {
+                    parents[neighbor.idx] = idx;
+                    costs[neighbor.idx] = weight;
+                }
+            }
+        }
+
+        _children.assign(size, {});
+        for (int p = 0; p < size; p++)
+            for (int v = 0; v < size; v++)
+                if (parents[v] == p) _children[p].push_back(v);
+        return parents;
+    }
+
+    // Sum over the tree edges of the lightest edge between a vertex and its parent, in either direction
+    double TreeWeight(const Adjacency& _adjacency, const std::vector<float>& _weights, const std::vector<VertexIdx>& _parents)
+    {
+        double total = 0;
+        for (int v = 0; v < static_cast<int>(_parents.size()); v++)
+        {
+            if (_parents[v] < 0) continue;
+            float lightest = MAX_FLOAT;
+            for (const Neighbor neighbor : _adjacency.Outgoing(v))
+                if (neighbor.idx == _parents[v]) lightest = std::min(lightest, _weights[neighbor.edge_idx]);
+            for (const Neighbor neighbor : _adjacency.Incoming(v))
+                if (neighbor.idx == _parents[v]) lightest = std::min(lightest, _weights[neighbor.edge_idx]);
+            // Trees of unreached vertices hang from the root without an edge
+            if (lightest < MAX_FLOAT) total += lightest;
+        }
+        return total;
+    }
+
+    // Leaves and levels of a subtree by recursion, as ITree counted them before the cache
+    uint LeavesReference(const ITree& _tree, VertexIdx _v)
+    {
+        uint leaves = _tree.FirstChild(_v) == ITree::NONE ? 1 : 0;
+        for (VertexIdx child = _tree.FirstChild(_v); child != ITree::NONE; child = _tree.NextSibling(child))
+            leaves += LeavesReference(_tree, child);
+        return leaves;
+    }
+    uint DepthReference(const ITree& _tree, VertexIdx _v)
+    {
+        uint max = 0;
+        for (VertexIdx child = _tree.FirstChild(_v); child != ITree::NONE; child = _tree.NextSibling(child))
+            max = std::max(max, DepthReference(_tree, child));
+        return max + 1;
+    }
+
+    // The recursive RadialLayout::SubTree, counting the leaves below every vertex it visits
+    void RadialSubTreeReference(ITree& _tree, VertexIdx _v, float _wedge_start, float _wedge_end, int _depth, float _start, float _step)
+    {
+        float new_wedge_start = _wedge_start;
+        const float radius = _start + (_step * _depth);
+        const uint parent_leaves = LeavesReference(_tree, _v);
+        for (VertexIdx child = _tree.FirstChild(_v); child != ITree::NONE; child = _tree.NextSibling(child))
+        {
+            const uint child_leaves = LeavesReference(_tree, child);
+            const float new_wedge_end = new_wedge_start +
+                static_cast<float>(child_leaves) / static_cast<float>(parent_leaves) * (_wedge_end - _wedge_start);
+            const float angle = (new_wedge_start + new_wedge_end) * .5f;
+            _tree.nodes[child]->SetNewPosition(glm::vec3(radius * glm::cos(angle), radius * glm::sin(angle), 0));
+            if (_tree.FirstChild(child) != ITree::NONE)
+                RadialSubTreeReference(_tree, child, new_wedge_start, new_wedge_end, _depth + 1, _start, _step);
+            new_wedge_start = new_wedge_end;
+        }
+    }
+
+    // Clusters::Update as it was, a linear search over the sub-graphs for both owners and a forced rebuild of every inter edge
+    void ClusterFrameReference(Clusters& _clusters, float _delta_time)
+    {
+        for (const auto& graph : _clusters.sub_graphs)
+            graph->Update(_delta_time);
+        for (const auto& edge : _clusters.edges)
+            edge->Update(_delta_time);
+
+        auto find_sub_graph = [&](const std::string _id) -> std::shared_ptr<Graph>
+        {
+            for (auto& graph : _clusters.sub_graphs)
+                if (graph->dataset->GetId() == _id) return graph;
+            return nullptr;
+        };
+        const auto& dataset = *_clusters.dataset;
+        for (size_t i = 0; i < _clusters.edges.size(); i++)
+        {
+            const auto& edge = dataset.edges[i];
+            const auto& start_vertex = dataset.vertices[edge.from_idx];
+            const auto& end_vertex = dataset.vertices[edge.to_idx];
+            const auto start_graph = find_sub_graph(start_vertex->owner);
+            const auto end_graph = find_sub_graph(end_vertex->owner);
+            const auto& edge_path = _clusters.edges[i];
+            edge_path->UpdateStartPoint(start_graph->nodes[start_vertex->idx]->GetNewPosition() + start_graph->GetPosition());
+            edge_path->UpdateEndPoint(end_graph->nodes[end_vertex->idx]->GetNewPosition() + end_graph->GetPosition());
+            edge_path->ForceUpdate();
+            edge_path->SetArrowOffset(end_graph->nodes[end_vertex->idx]->GetRadius() * 2);
+        }
+    }
+
+    // IStructure::UpdateEdges as it was, every edge gets its end points set and its path rebuilt
+    void UpdateEdgesReference(IStructure& _structure, bool _force)
+    {
+        const auto& nodes = _structure.nodes;
+        for (size_t i = 0; i < _structure.dataset->edges.size(); i++)
+        {
+            const auto& edge = _structure.dataset->edges[i];
+            const auto& edge_path = _structure.edges[i];
+            edge_path->UpdateStartPoint(nodes[edge.from_idx]->GetNewPosition());
+            edge_path->UpdateEndPoint(nodes[edge.to_idx]->GetNewPosition());
+            if (_force) edge_path->ForceUpdate();
+            edge_path->SetArrowOffset(nodes[edge.to_idx]->GetRadius() * 2);
+        }
+    }
+
+    // Whether the cached subtree properties of every vertex match a recount, and the order is a depth first pre-order
+    bool TopologyMatches(const ITree& _tree)
+    {
+        const auto& order = _tree.Order();
+        if (order.size() != _tree.nodes.size() || order.front() != _tree.Root()) return false;
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            const VertexIdx v = order[i];
+            if (_tree.Leaves(v) != LeavesReference(_tree, v) || _tree.Depth(v) != DepthReference(_tree, v))
+                return false;
+            // The next vertex is the first child, or the next sibling of the vertex or one of its ancestors
+            if (i + 1 == order.size()) continue;
+            VertexIdx next = _tree.FirstChild(v);
+            for (VertexIdx u = v; next == ITree::NONE && u != _tree.Root(); u = _tree.Parent(u))
+                next = _tree.NextSibling(u);
+            if (next != order[i + 1]) return false;
+        }
+        return true;
+    }
+} // namespace
+
+//--------------------------------------------------------------
+// All Pairs Shortest Paths
+//--------------------------------------------------------------
+void AllPairsShortestPaths(const Datasets& _datasets)
+{
+    std::cout << "Benchmark: All Pairs Shortest Paths (" << ThreadPool::Global().Size() << " threads)" << std::endl;
+    for (const auto& dataset : _datasets)
+    {
+        // Clusters only keep the inter edges at the top level
+        if (dataset->vertices.empty()) continue;
+
+        std::unique_ptr<smat::Matrix<double>> D_reference, D;
+        Timer timer;
+        FloydWarshall(*dataset, D_reference);
+        const float reference_ms = timer.ElapsedMs();
+
+        timer.Reset();
+        ShortestPaths::AllPairs(*dataset, D);
+        const float ms = timer.ElapsedMs();
+
+        // Floyd-Warshall accumulates in float, so allow a small relative error
+        int mismatches = 0;
+        const int size = dataset->vertices.size();
+        for (int i = 0; i < size; i++)
+            for (int j = 0; j < size; j++)
+            {
+                const double expected = D_reference->get(i, j);
+                if (std::abs(expected - D->get(i, j)) > 1e-4 * std::max(1.0, expected)) mismatches++;
+            }
+
+        std::cout << dataset->GetFilename()
+            << " | vertices: " << size
+            << " | edges: " << dataset->edges.size()
+            << " | weighted: " << (ShortestPaths::IsWeighted(*dataset) ? "yes" : "no")
+            << " | floyd-warshall: " << reference_ms << " ms"
+            << " | apsp: " << ms << " ms"
+            << " | speedup: " << reference_ms / std::max(ms, 1e-3f) << "x"
+            << " | mismatches: " << mismatches << std::endl;
+    }
+}
+
+//--------------------------------------------------------------
+// Force Directed
+//--------------------------------------------------------------
+void ForceDirected(const Datasets& _datasets)
+{
+    constexpr int iterations = 20;
+    std::cout << "Benchmark: Force Directed, iterations/s over " << iterations << " iterations" << std::endl;
+    for (const auto& dataset : _datasets)
+    {
+        if (std::dynamic_pointer_cast<ClusterDataset>(dataset)) continue;
+
+        Graph graph;
+        graph.Init(dataset);
+        RandomLayout::Apply(graph, 800, 800);
+        Settle(graph);
+
+        std::vector<glm::vec3> start;
+        for (const auto& node : graph.nodes)
+            start.push_back(node->GetPosition());
+
+        // Every run starts from the same positions
+        auto run = [&](bool _barnes_hut, float _theta, uint _threads)
+        {
+            for (size_t i = 0; i < start.size(); i++)
+                graph.nodes[i]->SetPosition(start[i]);
+            Timer timer;
+            ForceDirectedLayout::Apply(graph, 0.5f, 0.002f, iterations, _barnes_hut, _theta, _threads);
+            return iterations * 1000.f / std::max(timer.ElapsedMs(), 1e-3f);
+        };
+        auto positions = [&]()
+        {
+            std::vector<glm::vec3> out;
+            for (const auto& node : graph.nodes)
+                out.push_back(node->GetPosition());
+            return out;
+        };
+
+        std::cout << dataset->GetFilename() << " | vertices: " << graph.nodes.size();
+        const float serial = run(false, 0, 1);
+        const auto serial_positions = positions();
+        std::cout << " | exact 1 thread: " << serial;
+        // The parallel kernel has to reproduce the serial result exactly
+        for (uint threads = 2; threads <= ThreadPool::Global().Size(); threads *= 2)
+        {
+            const float parallel = run(false, 0, threads);
+            std::cout << " | " << threads << " threads: " << parallel
+                << (positions() == serial_positions ? "" : " (MISMATCH)");
+        }
+        std::cout << " | barnes-hut (theta 0.5): " << run(true, .5f, 0)
+            << " | barnes-hut (theta 1.0): " << run(true, 1.f, 0) << std::endl;
+    }
+}
+
+//--------------------------------------------------------------
+// DOT Parsers
+//--------------------------------------------------------------
+void DotParsers(const std::vector<std::string>& _filenames)
+{
+    std::cout << "Benchmark: DOT Parsers, MB/s including Dataset::Load" << std::endl;
+    for (const auto& filename : _filenames)
+    {
+        const float megabytes = std::filesystem::file_size(ofToDataPath(filename, false)) / (1024.f * 1024.f);
+        auto mb_per_s = [&](float _ms) { return megabytes * 1000.f / std::max(_ms, 1e-3f); };
+
+        Timer timer;
+        std::shared_ptr<Dataset> fast;
+        if (Parser::DotGraph graph; Parser::FastDotFile(filename, graph))
+        {
+            fast = graph.clusters.empty() ? std::make_shared<Dataset>() : std::make_shared<ClusterDataset>();
+            fast->Load(graph, filename);
+        }
+        const float fast_ms = timer.ElapsedMs();
+
+        timer.Reset();
+        std::shared_ptr<Dataset> spirit;
+        if (Model::MainGraph graph; Parser::DotFile(filename, graph))
+        {
+            spirit = graph.graph.subgraphs.empty() ? std::make_shared<Dataset>() : std::make_shared<ClusterDataset>();
+            spirit->Load(graph, filename);
+        }
+        const float spirit_ms = timer.ElapsedMs();
+
+        std::cout << filename << " | " << megabytes << " MB"
+            << " | fast: " << (fast ? std::to_string(mb_per_s(fast_ms)) + " MB/s" : "failed")
+            << " | spirit: " << (spirit ? std::to_string(mb_per_s(spirit_ms)) + " MB/s" : "failed after " + std::to_string(spirit_ms) + " ms");
+        if (fast && spirit)
+            std::cout << " | speedup: " << spirit_ms / std::max(fast_ms, 1e-3f) << "x"
+                << " | datasets " << (SameDataset(*fast, *spirit) ? "identical" : "DIFFER");
+        std::cout << std::endl;
+    }
+}
+
+//--------------------------------------------------------------
+// Snapshots
+//--------------------------------------------------------------
+void Snapshots(const std::vector<std::string>& _filenames)
+{
+    std::cout << "Benchmark: Snapshots, ms to a loaded Dataset" << std::endl;
+    float total_parse_ms = 0, total_snapshot_ms = 0;
+    for (const auto& filename : _filenames)
+    {
+        Timer timer;
+        std::shared_ptr<Dataset> parsed;
+        if (Parser::DotGraph graph; Parser::FastDotFile(filename, graph))
+        {
+            parsed = graph.clusters.empty() ? std::make_shared<Dataset>() : std::make_shared<ClusterDataset>();
+            parsed->Load(graph, filename);
+        }
+        const float parse_ms = timer.ElapsedMs();
+        if (!parsed) continue;
+
+        if (!Snapshot::Load(filename))
+            Snapshot::Save(*parsed, filename);
+        timer.Reset();
+        const auto snapshot = Snapshot::Load(filename);
+        const float snapshot_ms = timer.ElapsedMs();
+
+        total_parse_ms += parse_ms;
+        total_snapshot_ms += snapshot_ms;
+        std::cout << filename << " | parse: " << parse_ms << " ms"
+            << " | snapshot: " << (snapshot ? std::to_string(snapshot_ms) + " ms" : "failed");
+        if (snapshot)
+            std::cout << " | speedup: " << parse_ms / std::max(snapshot_ms, 1e-3f) << "x"
+                << " | datasets " << (SameDataset(*parsed, *snapshot) ? "identical" : "DIFFER");
+        std::cout << std::endl;
+    }
+    std::cout << "total | parse: " << total_parse_ms << " ms | snapshot: " << total_snapshot_ms << " ms" << std::endl;
+}
+
+//--------------------------------------------------------------
+// Bilayer Crossings
+//--------------------------------------------------------------
+void BilayerCrossings(const Datasets& _datasets)
+{
+    constexpr int shuffles = 20;
+    // The quadratic reference and the restarts of the framework take minutes on polblogs
+    constexpr size_t max_vertices = 1000;
+    std::cout << "Benchmark: Bilayer Crossings, ms to count the crossings of all layers over " << shuffles << " shuffles" << std::endl;
+    for (const auto& dataset : _datasets)
+    {
+        if (dataset->vertices.empty() || dataset->vertices.size() > max_vertices) continue;
+
+        // The layers Sugiyama counts the crossings of, including the dummy vertices
+        SugiyamaLayout::LayeredGraph layered;
+        layered.Init(*dataset);
+        SugiyamaLayout::BreakCycles(layered);
+        std::vector<SugiyamaLayout::Layer> vertices_per_layer;
+        SugiyamaLayout::Layer layer_per_vertex;
+        SugiyamaLayout::LayerAssignment(layered, vertices_per_layer, layer_per_vertex);
+        SugiyamaLayout::AddDummyVertices(layered, vertices_per_layer, layer_per_vertex);
+        const Adjacency& adjacency = layered.adjacency;
+
+        // Both counters see the same random orders of every layer
+        std::mt19937 rng(42);
+        float reference_ms = 0, tree_ms = 0;
+        long long crossings = 0;
+        bool same = true;
+        for (int s = 0; s < shuffles; s++)
+        {
+            for (auto& layer : vertices_per_layer)
+                std::shuffle(layer.begin(), layer.end(), rng);
+
+            std::vector<int> reference(vertices_per_layer.size(), 0), tree(vertices_per_layer.size(), 0);
+            Timer timer;
+            for (size_t j = 1; j < vertices_per_layer.size(); j++)
+                reference[j] = CrossingsReference(adjacency, vertices_per_layer[j - 1], vertices_per_layer[j]);
+            reference_ms += timer.ElapsedMs();
+            timer.Reset();
+            for (size_t j = 1; j < vertices_per_layer.size(); j++)
+                tree[j] = SugiyamaLayout::Crossings(adjacency, vertices_per_layer[j - 1], vertices_per_layer[j]);
+            tree_ms += timer.ElapsedMs();
+
+            same = same && reference == tree;
+            for (const int c : tree) crossings += c;
+        }
+
+        // The whole framework with the default heuristic and iterations of the gui
+        LayoutJob::Progress progress;
+        Timer timer;
+        SugiyamaLayout::Compute(*dataset, SugiyamaLayout::OSCMBarycenterHeuristic, SugiyamaLayout::Layering::LongestPath,
+                                glm::vec2(50, -200), 100, 42, false, progress);
+        const float sugiyama_ms = timer.ElapsedMs();
+
+        std::cout << dataset->GetFilename() << " | layers: " << vertices_per_layer.size() << " | vertices: " << layered.vertex_count
+            << " | crossings/shuffle: " << crossings / shuffles
+            << " | reference: " << reference_ms << " ms | accumulator tree: " << tree_ms << " ms"
+            << " | speedup: " << reference_ms / std::max(tree_ms, 1e-3f) << "x"
+            << " | counts " << (same ? "identical" : "MISMATCH")
+            << " | sugiyama: " << sugiyama_ms << " ms" << std::endl;
+    }
+}
+
+//--------------------------------------------------------------
+// Cycle Breaking
+//--------------------------------------------------------------
+void CycleBreaking()
+{
+    std::cout << "Benchmark: Cycle Breaking, ms on random graphs with 4 edges per vertex" << std::endl;
+    std::mt19937 rng(42);
+    for (int edge_count = 12500; edge_count <= 100000; edge_count *= 2)
+    {
+        const int vertex_count = edge_count / 4;
+        std::cout << "edges: " << edge_count;
+        // A DAG needs no reversed edges, the others have 5% and 25% of their edges turned around
+        for (const float back_edges : {0.f, .05f, .25f})
+        {
+            auto graph = SyntheticGraph(vertex_count, edge_count, back_edges, rng);
+            auto reference = graph;
+
+            Timer timer;
+            SugiyamaLayout::BreakCycles(graph);
+            const float buckets_ms = timer.ElapsedMs();
+            timer.Reset();
+            BreakCyclesReference(reference);
+            const float reference_ms = timer.ElapsedMs();
+
+            const auto reversed = std::count(graph.reversed.begin(), graph.reversed.end(), true);
+            const auto reference_reversed = std::count(reference.reversed.begin(), reference.reversed.end(), true);
+            std::cout << " | " << back_edges * 100 << "% back: bucket queues " << buckets_ms << " ms, reference " << reference_ms << " ms"
+                << ", reversed " << reversed << " (reference " << reference_reversed << ")"
+                << (IsAcyclic(graph) ? "" : " CYCLIC");
+        }
+        std::cout << std::endl;
+    }
+}
+
+//--------------------------------------------------------------
+// Layering
+//--------------------------------------------------------------
+void Layering(const Datasets& _datasets)
+{
+    // The restarts of the crossing minimization take minutes on polblogs
+    constexpr size_t max_vertices = 1000;
+    std::cout << "Benchmark: Layering, dummy vertices and ms of the longest path and the network simplex layering" << std::endl;
+    for (const auto& dataset : _datasets)
+    {
+        if (dataset->vertices.empty() || dataset->vertices.size() > max_vertices) continue;
+
+        // The whole framework with the default heuristic and iterations of the gui
+        LayoutJob::Progress progress;
+        const auto longest_path = SugiyamaLayout::Compute(*dataset, SugiyamaLayout::OSCMBarycenterHeuristic,
+            SugiyamaLayout::Layering::LongestPath, glm::vec2(50, -200), 100, 42, false, progress).statistics;
+        const auto network_simplex = SugiyamaLayout::Compute(*dataset, SugiyamaLayout::OSCMBarycenterHeuristic,
+            SugiyamaLayout::Layering::NetworkSimplex, glm::vec2(50, -200), 100, 42, false, progress).statistics;
+
+        const float saved_ms = longest_path.layering_ms + longest_path.downstream_ms
+            - network_simplex.layering_ms - network_simplex.downstream_ms;
+        std::cout << dataset->GetFilename()
+            << " | longest path: " << longest_path.dummy_vertices << " dummies, " << longest_path.layering_ms << " + "
+            << longest_path.downstream_ms << " ms"
+            << " | network simplex: " << network_simplex.dummy_vertices << " dummies, " << network_simplex.layering_ms << " + "
+            << network_simplex.downstream_ms << " ms"
+            << " | saved: " << saved_ms << " ms" << std::endl;
+    }
+}
+
+//--------------------------------------------------------------
+// Crossing Minimization
+//--------------------------------------------------------------
+void CrossingMinimization(const Datasets& _datasets)
+{
+    constexpr int restarts = 100;
+    constexpr uint seed = 42;
+    // The sequential restarts take minutes on polblogs
+    constexpr size_t max_vertices = 1000;
+    const int threads = static_cast<int>(ThreadPool::Global().Size());
+    std::cout << "Benchmark: Crossing Minimization, " << restarts << " sequential against parallel restarts on "
+        << threads << " threads" << std::endl;
+    for (const auto& dataset : _datasets)
+    {
+        if (dataset->vertices.empty() || dataset->vertices.size() > max_vertices) continue;
+
+        SugiyamaLayout::LayeredGraph layered;
+        layered.Init(*dataset);
+        SugiyamaLayout::BreakCycles(layered);
+        std::vector<SugiyamaLayout::Layer> vertices_per_layer;
+        SugiyamaLayout::Layer layer_per_vertex;
+        SugiyamaLayout::LayerAssignment(layered, vertices_per_layer, layer_per_vertex);
+        SugiyamaLayout::AddDummyVertices(layered, vertices_per_layer, layer_per_vertex);
+
+        LayoutJob::Progress progress;
+        auto run = [&](int _restarts, uint _seed, bool _parallel, std::vector<SugiyamaLayout::Layer>& _layers, uint& _winning_seed)
+        {
+            _layers = vertices_per_layer;
+            return SugiyamaLayout::CrossingMinimization(layered, _layers, SugiyamaLayout::OSCMBarycenterHeuristic, _restarts,
+                                                        progress, _seed, _parallel, &_winning_seed);
+        };
+
+        std::vector<SugiyamaLayout::Layer> sequential, parallel, more, reproduced;
+        uint sequential_seed = 0, parallel_seed = 0, more_seed = 0, reproduced_seed = 0;
+        Timer timer;
+        const int sequential_crossings = run(restarts, seed, false, sequential, sequential_seed);
+        const float sequential_ms = timer.ElapsedMs();
+        timer.Reset();
+        const int parallel_crossings = run(restarts, seed, true, parallel, parallel_seed);
+        const float parallel_ms = timer.ElapsedMs();
+        // As many restarts as the threads run in about the time of the sequential ones
+        timer.Reset();
+        const int more_crossings = run(restarts * threads, seed, true, more, more_seed);
+        const float more_ms = timer.ElapsedMs();
+        // The winning seed on its own gives the winning layers
+        run(1, parallel_seed, false, reproduced, reproduced_seed);
+
+        std::cout << dataset->GetFilename()
+            << " | sequential: " << sequential_crossings << " crossings, " << sequential_ms << " ms"
+            << " | parallel: " << parallel_crossings << " crossings, " << parallel_ms << " ms"
+            << " (" << (sequential == parallel && sequential_seed == parallel_seed ? "identical" : "MISMATCH") << ")"
+            << " | " << restarts * threads << " parallel: " << more_crossings << " crossings, " << more_ms << " ms"
+            << " | seed " << parallel_seed << (reproduced == parallel ? " reproduces" : " DOES NOT REPRODUCE") << std::endl;
+    }
+}
+
+//--------------------------------------------------------------
+// Vertex Positioning
+//--------------------------------------------------------------
+void VertexPositioning(const Datasets& _datasets)
+{
+    constexpr float delta = 50;
+    // The recursion of the reference overflows the stack on polblogs
+    constexpr size_t max_vertices = 1000;
+    std::cout << "Benchmark: Vertex Positioning, ms of one alignment against four balanced alignments" << std::endl;
+    for (const auto& dataset : _datasets)
+    {
+        if (dataset->vertices.empty() || dataset->vertices.size() > max_vertices) continue;
+
+        SugiyamaLayout::LayeredGraph layered;
+        layered.Init(*dataset);
+        SugiyamaLayout::BreakCycles(layered);
+        std::vector<SugiyamaLayout::Layer> vertices_per_layer;
+        SugiyamaLayout::Layer layer_per_vertex;
+        SugiyamaLayout::LayerAssignment(layered, vertices_per_layer, layer_per_vertex);
+        SugiyamaLayout::AddDummyVertices(layered, vertices_per_layer, layer_per_vertex);
+        LayoutJob::Progress progress;
+        SugiyamaLayout::CrossingMinimization(layered, vertices_per_layer, SugiyamaLayout::OSCMBarycenterHeuristic, 10, progress, 42, true);
+
+        Timer timer;
+        const auto reference = VertexPositioningReference(layered, vertices_per_layer, layer_per_vertex, delta);
+        const float reference_ms = timer.ElapsedMs();
+        timer.Reset();
+        const auto balanced = SugiyamaLayout::VertexPositioning(layered, vertices_per_layer, delta);
+        const float balanced_ms = timer.ElapsedMs();
+
+        // Neighbors on a layer closer than delta
+        auto overlaps = [&](const std::vector<float>& _x)
+        {
+            int count = 0;
+            for (const auto& layer : vertices_per_layer)
+                for (size_t k = 1; k < layer.size(); k++)
+                    count += _x[layer[k]] - _x[layer[k - 1]] < delta - 1e-2f;
+            return count;
+        };
+
+        auto width = [](const std::vector<float>& _x) { return *std::max_element(_x.begin(), _x.end()) - *std::min_element(_x.begin(), _x.end()); };
+        const auto [reference_slant, reference_straight] = EdgeSlant(layered, reference);
+        const auto [balanced_slant, balanced_straight] = EdgeSlant(layered, balanced);
+        std::cout << dataset->GetFilename() << " | vertices: " << layered.vertex_count << " | edges: " << layered.from.size()
+            << " | reference: " << reference_ms << " ms, width " << width(reference) << ", slant " << reference_slant
+            << ", straight edges " << reference_straight << ", overlaps " << overlaps(reference)
+            << " | balanced: " << balanced_ms << " ms, width " << width(balanced) << ", slant " << balanced_slant
+            << ", straight edges " << balanced_straight << ", overlaps " << overlaps(balanced) << std::endl;
+    }
+}
+
+//--------------------------------------------------------------
+// Crossing Metric
+//--------------------------------------------------------------
+void CrossingMetric(const Datasets& _datasets)
+{
+    // The reference is quadratic in the segments, bundled edges are only compared on the smaller datasets
+    constexpr size_t max_bundled_edges = 1000;
+    std::cout << "Benchmark: Crossing Metric, ms of the grid (" << ThreadPool::Global().Size()
+        << " threads) against all pairs of segments" << std::endl;
+    std::cout << "random straight edges: " << (CrossingMetricCheck(1) ? "identical" : "MISMATCH") << std::endl;
+    for (const auto& dataset : _datasets)
+    {
+        if (std::dynamic_pointer_cast<ClusterDataset>(dataset)) continue;
+
+        Graph graph;
+        graph.Init(dataset);
+        auto compare = [&](const char* _name)
+        {
+            // The metric reads the final positions
+            Settle(graph);
+            size_t segments = 0;
+            for (const auto& edge : graph.edges)
+                segments += std::max<size_t>(edge->points.size(), 1) - 1;
+
+            Timer timer;
+            const auto reference = EdgeCrossingsReference(graph.edges);
+            const float reference_ms = timer.ElapsedMs();
+            timer.Reset();
+            const auto grid = GraphQualityMetrics::Crossings(graph.edges);
+            const float grid_ms = timer.ElapsedMs();
+            std::cout << " | " << _name << ": " << segments << " segments, " << grid.first << " crossings, grid "
+                << grid_ms << " ms, reference " << reference_ms << " ms"
+                << (SameCrossings(grid, reference) ? " (identical)" : " (MISMATCH)");
+        };
+
+        std::cout << dataset->GetFilename() << " | edges: " << graph.edges.size();
+        RandomLayout::Apply(graph, 800, 800);
+        compare("random");
+        SugiyamaLayout::Apply(graph, SugiyamaLayout::OSCMBarycenterHeuristic, { 50, -200 }, 10, true);
+        compare("sugiyama");
+        if (graph.edges.size() <= max_bundled_edges)
+        {
+            RandomLayout::Apply(graph, 800, 800);
+            Settle(graph);
+            EdgeBundlingLayout::Apply(graph, 3, 30, .1f, 1, .004f, .05f, true, false,
+                [](const EdgePath&, const EdgePath&) { return 1.f; });
+            compare("bundled");
+        }
+        std::cout << std::endl;
+    }
+}
+
+//--------------------------------------------------------------
+// Neighborhood Preservation
+//--------------------------------------------------------------
+void NeighborhoodPreservation(const Datasets& _datasets)
+{
+    constexpr int K = 10;
+    std::cout << "Benchmark: Trustworthiness and Continuity (K = " << K << "), ms of the kd-tree pass ("
+        << ThreadPool::Global().Size() << " threads) against a sort per vertex" << std::endl;
+    for (const auto& dataset : _datasets)
+    {
+        if (std::dynamic_pointer_cast<ClusterDataset>(dataset) || dataset->vertices.size() <= 2 * K) continue;
+
+        Graph graph;
+        graph.Init(dataset);
+        RandomLayout::Apply(graph, 800, 800);
+        Settle(graph);
+        // Both read the cached neighbor lists, only the metrics are timed
+        dataset->GetDistanceCache().GetRanks(*dataset);
+
+        Timer timer;
+        const auto reference = TrustworthinessContinuityReference(graph, K);
+        const float reference_ms = timer.ElapsedMs();
+        timer.Reset();
+        const auto kd_tree = DRQualityMetrics::TrustworthinessContinuity(graph, K);
+        const float kd_tree_ms = timer.ElapsedMs();
+
+        // The reference sums in float, the kd-tree pass in double
+        const bool same = std::abs(reference.first - kd_tree.first) < 1e-4f && std::abs(reference.second - kd_tree.second) < 1e-4f;
+        std::cout << dataset->GetFilename() << " | vertices: " << graph.nodes.size()
+            << " | trustworthiness: " << kd_tree.first << " | continuity: " << kd_tree.second
+            << " | kd-tree: " << kd_tree_ms << " ms | reference: " << reference_ms << " ms"
+            << (same ? " (identical)" : " (MISMATCH)") << std::endl;
+    }
+}
+
+//--------------------------------------------------------------
+// Minimum Spanning Tree
+//--------------------------------------------------------------
+void MinimumSpanningTree(const Datasets& _datasets)
+{
+    // The quadratic reference takes minutes on the synthetic graph
+    constexpr size_t max_reference_vertices = 20000;
+    std::cout << "Benchmark: Minimum Spanning Tree, ms of the heap Prim and Boruvka (" << ThreadPool::Global().Size()
+        << " threads) against the quadratic Prim" << std::endl;
+
+    auto run = [&](const std::string& _name, const Adjacency& _adjacency, const std::vector<float>& _weights, bool _undirected)
+    {
+        const size_t size = _adjacency.Size();
+        Timer timer;
+        const auto prim = MSP::Prim(_adjacency, _weights, 0);
+        // Children in one pass, as MSP::Create does
+        std::vector<std::vector<VertexIdx>> children(size);
+        for (size_t v = 0; v < size; v++)
+            if (prim[v] >= 0) children[prim[v]].push_back(static_cast<VertexIdx>(v));
+        const float prim_ms = timer.ElapsedMs();
+        timer.Reset();
+        const auto boruvka = MSP::Boruvka(_adjacency, _weights, 0);
+        const float boruvka_ms = timer.ElapsedMs();
+
+        std::cout << _name << " | vertices: " << size << " | heap prim: " << prim_ms << " ms | boruvka: " << boruvka_ms << " ms";
+        if (size <= max_reference_vertices)
+        {
+            std::vector<std::vector<VertexIdx>> reference_children;
+            timer.Reset();
+            const auto reference = MinimumSpanningTreeReference(_adjacency, _weights, 0, reference_children);
+            const float reference_ms = timer.ElapsedMs();
+            std::cout << " | reference: " << reference_ms << " ms" << (reference == prim && reference_children == children ? " (identical)" : " (MISMATCH)");
+        }
+        // Prim follows the outgoing edges only, the weights agree on undirected graphs
+        const double prim_weight = TreeWeight(_adjacency, _weights, prim);
+        const double boruvka_weight = TreeWeight(_adjacency, _weights, boruvka);
+        std::cout << " | weight: " << prim_weight;
+        if (_undirected)
+            std::cout << (std::abs(prim_weight - boruvka_weight) <= 1e-6 * std::max(1.0, prim_weight) ? " (boruvka identical)" : " (boruvka MISMATCH)");
+        std::cout << std::endl;
+    };
+
+    for (const auto& dataset : _datasets)
+    {
+        if (dataset->vertices.empty()) continue;
+        std::vector<float> weights(dataset->edges.size());
+        for (size_t e = 0; e < weights.size(); e++)
+            weights[e] = dataset->edges[e].attributes.FindFloat("weight", 1);
+        run(dataset->GetFilename(), dataset->GetAdjacency(), weights, dataset->GetKind() == Dataset::Kind::Undirected);
+    }
+
+    // Random undirected graph with 1M edges stored in both directions, both directions share a weight
+    constexpr int vertex_count = 100000, edge_count = 1000000;
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> vertex(0, vertex_count - 1);
+    std::uniform_real_distribution<float> weight(0, 1);
+    std::vector<VertexIdx> from, to;
+    std::vector<float> weights;
+    // A path through all vertices keeps the graph connected
+    for (int v = 1; v < vertex_count; v++)
+    {
+        const float w = weight(rng);
+        from.insert(from.end(), { v - 1, v });
+        to.insert(to.end(), { v, v - 1 });
+        weights.insert(weights.end(), { w, w });
+    }
+    while (static_cast<int>(weights.size()) < 2 * edge_count)
+    {
+        const int a = vertex(rng), b = vertex(rng);
+        if (a == b) continue;
+        const float w = weight(rng);
+        from.insert(from.end(), { a, b });
+        to.insert(to.end(), { b, a });
+        weights.insert(weights.end(), { w, w });
+    }
+    Adjacency adjacency;
+    adjacency.Build(from, to, vertex_count);
+    run("synthetic 1M edges", adjacency, weights, true);
+}
+
+//--------------------------------------------------------------
+// Radial Tree
+//--------------------------------------------------------------
+void RadialTree(const Datasets& _datasets)
+{
+    constexpr float start = 0, step = 100;
+    std::cout << "Benchmark: Radial Tree, ms of the radial layout of the MSP tree against the recursive layout counting leaves per vertex,"
+        " and of making the deepest leaf the root" << std::endl;
+    for (const auto& dataset : _datasets)
+    {
+        if (std::dynamic_pointer_cast<ClusterDataset>(dataset) || dataset->vertices.empty()) continue;
+
+        MSP tree;
+        tree.Init(dataset);
+        bool same = TopologyMatches(tree);
+
+        Timer timer;
+        RadialLayout::Apply(tree, start, step);
+        const float cached_ms = timer.ElapsedMs();
+        std::vector<glm::vec3> positions;
+        for (const auto& node : tree.nodes) positions.push_back(node->GetNewPosition());
+        // Same steps as RadialLayout::Apply
+        timer.Reset();
+        tree.nodes[tree.Root()]->SetNewPosition(glm::vec3(0));
+        RadialSubTreeReference(tree, tree.Root(), 0, TWO_PI, 0, start, step);
+        tree.UpdateAABB();
+        tree.UpdateEdges();
+        const float reference_ms = timer.ElapsedMs();
+        for (size_t i = 0; i < tree.nodes.size(); i++)
+            same &= positions[i] == tree.nodes[i]->GetNewPosition();
+
+        // The deepest leaf moves the root the furthest
+        VertexIdx deepest = tree.Root();
+        while (tree.FirstChild(deepest) != ITree::NONE)
+        {
+            VertexIdx next = tree.FirstChild(deepest);
+            for (VertexIdx child = next; child != ITree::NONE; child = tree.NextSibling(child))
+                if (tree.Depth(child) > tree.Depth(next)) next = child;
+            deepest = next;
+        }
+        timer.Reset();
+        tree.SwapRoot(deepest);
+        const float swap_ms = timer.ElapsedMs();
+        same &= TopologyMatches(tree);
+
+        std::cout << dataset->GetFilename() << " | nodes: " << tree.nodes.size() << " | leaves: " << tree.leaves << " | depth: " << tree.depth
+            << " | cached: " << cached_ms << " ms | reference: " << reference_ms << " ms | swap root: " << swap_ms << " ms"
+            << (same ? " (identical)" : " (MISMATCH)") << std::endl;
+    }
+}
+
+//--------------------------------------------------------------
+// Cluster Frames
+//--------------------------------------------------------------
+void ClusterFrames(const Datasets& _datasets)
+{
+    constexpr int frames = 600;
+    constexpr float delta_time = 1 / 60.f;
+    std::cout << "Benchmark: Cluster Frames, ms per frame of Clusters::Update against a rebuild of every inter edge, "
+        "at rest and while a sub-graph is dragged" << std::endl;
+    for (const auto& dataset : _datasets)
+    {
+        if (!std::dynamic_pointer_cast<ClusterDataset>(dataset)) continue;
+
+        Clusters clusters;
+        clusters.Init(dataset);
+        auto run = [&](bool _reference, bool _drag)
+        {
+            Timer timer;
+            for (int frame = 0; frame < frames; frame++)
+            {
+                if (_drag) clusters.sub_graphs.front()->Move(glm::vec3(1, 0, 0));
+                if (_reference) ClusterFrameReference(clusters, delta_time);
+                else clusters.Update(delta_time);
+            }
+            return timer.ElapsedMs() / frames;
+        };
+
+        const float rest_ms = run(false, false), rest_reference_ms = run(true, false);
+        const float drag_ms = run(false, true), drag_reference_ms = run(true, true);
+
+        // The inter edges follow the dragged sub-graph as before
+        clusters.sub_graphs.front()->Move(glm::vec3(1, 0, 0));
+        clusters.Update(delta_time);
+        std::vector<std::pair<glm::vec3, glm::vec3>> ends;
+        for (const auto& edge : clusters.edges)
+            ends.emplace_back(edge->points.front().value, edge->points.back().value);
+        ClusterFrameReference(clusters, delta_time);
+        bool same = true;
+        for (size_t i = 0; i < clusters.edges.size(); i++)
+            same &= ends[i] == std::make_pair(clusters.edges[i]->points.front().value, clusters.edges[i]->points.back().value);
+
+        std::cout << dataset->GetFilename() << " | sub-graphs: " << clusters.sub_graphs.size() << " | inter edges: " << clusters.edges.size()
+            << " | at rest: " << rest_ms << " ms (reference " << rest_reference_ms << " ms)"
+            << " | dragging: " << drag_ms << " ms (reference " << drag_reference_ms << " ms)"
+            << (same ? " (identical)" : " (MISMATCH)") << std::endl;
+    }
+}
+
+//--------------------------------------------------------------
+// Edge Updates
+//--------------------------------------------------------------
+void EdgeUpdates(const Datasets& _datasets)
+{
+    std::cout << "Benchmark: Edge Updates, ms of IStructure::UpdateEdges after moving one node, 1% and all nodes, "
+        "against rebuilding every edge" << std::endl;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> coordinate(0, 800);
+    for (const auto& dataset : _datasets)
+    {
+        if (std::dynamic_pointer_cast<ClusterDataset>(dataset) || dataset->vertices.empty()) continue;
+
+        Graph graph;
+        graph.Init(dataset);
+        RandomLayout::Apply(graph, 800, 800);
+        const int size = static_cast<int>(graph.nodes.size());
+        std::uniform_int_distribution<int> vertex(0, size - 1);
+        auto move = [&](int _count)
+        {
+            for (int i = 0; i < _count; i++)
+                graph.nodes[vertex(rng)]->SetNewPosition(glm::vec3(coordinate(rng), coordinate(rng), 0));
+        };
+
+        std::cout << dataset->GetFilename() << " | edges: " << graph.edges.size();
+        bool same = true;
+        for (const int count : { 1, std::max(1, size / 100), size })
+        {
+            move(count);
+            // Starts a new frame for the counter
+            graph.Update(0);
+            Timer timer;
+            graph.UpdateEdges(true);
+            const float dirty_ms = timer.ElapsedMs();
+            graph.Update(0);
+            const int rebuilt = graph.EdgesRebuilt();
+
+            move(count);
+            timer.Reset();
+            UpdateEdgesReference(graph, true);
+            const float reference_ms = timer.ElapsedMs();
+            graph.UpdateEdges(true);
+
+            for (size_t i = 0; i < graph.edges.size(); i++)
+            {
+                const auto& edge = dataset->edges[i];
+                same &= graph.edges[i]->points.front().value == graph.nodes[edge.from_idx]->GetNewPosition()
+                    && graph.edges[i]->points.back().value == graph.nodes[edge.to_idx]->GetNewPosition();
+            }
+            std::cout << " | " << count << " moved: " << rebuilt << " rebuilt, " << dirty_ms << " ms (reference " << reference_ms << " ms)";
+        }
+        std::cout << (same ? " (identical)" : " (MISMATCH)") << std::endl;
+    }
+}
+} // namespace Benchmark
+} // namespace DataVis
+#endif // DATAVIS_BENCHMARKS
@@ -0,0 +1,67 @@
+#pragma once
+
+namespace DataVis
+{
+//--------------------------------------------------------------
+// Benchmarks
+//--------------------------------------------------------------
+/**
+ * Compare the optimized kernels against the kernels they replaced.
+ * Results are written to stdout, one line per dataset.
+ * The self checks need no datasets and are always built, main runs them with --check and exits non-zero on a failure.
+ */
+namespace Benchmark
+{
+    // GraphQualityMetrics::Crossings against all pairs of segments on random straight edges, prints every difference
+    bool CrossingMetricCheck(uint seed);
+
+#ifdef DATAVIS_BENCHMARKS
+    using Datasets = std::vector<std::shared_ptr<Dataset>>;
+
+    // FloydWarshall against ShortestPaths::AllPairs
+    void AllPairsShortestPaths(const Datasets&);
+
+    // Iterations per second of the exact and the Barnes-Hut force directed repulsion
+    void ForceDirected(const Datasets&);
+
+    // MB/s of Parser::FastDotFile against the Spirit parser, both including Dataset::Load
+    void DotParsers(const std::vector<std::string>& filenames);
+
+    // Load time of Snapshot::Load against parsing the .dot file, writes the snapshots when missing
+    void Snapshots(const std::vector<std::string>& filenames);
+
+    // SugiyamaLayout::Crossings against the quadratic counter it replaced on shuffled layers, and the whole framework
+    void BilayerCrossings(const Datasets&);
+
+    // SugiyamaLayout::BreakCycles against the quadratic greedy it replaced, on random graphs up to 100k edges
+    void CycleBreaking();
+
+    // Dummy vertices and time of the Sugiyama framework with the longest path against the network simplex layering
+    void Layering(const Datasets&);
+
+    // Crossings and time of the sequential and the parallel OSCM restarts, and whether the winning seed reproduces the layers
+    void CrossingMinimization(const Datasets&);
+
+    // SugiyamaLayout::VertexPositioning against the single alignment it replaced, time, width and edge slant
+    void VertexPositioning(const Datasets&);
+
+    // GraphQualityMetrics::Crossings against all pairs of segments, on straight, Sugiyama and bundled edges
+    void CrossingMetric(const Datasets&);
+
+    // DRQualityMetrics::TrustworthinessContinuity against a full sort per vertex, on a random layout
+    void NeighborhoodPreservation(const Datasets&);
+
+    // MSP::Prim with a heap and MSP::Boruvka against the quadratic Prim, on the datasets and a random graph with 1M edges
+    void MinimumSpanningTree(const Datasets&);
+
+    // RadialLayout on the MSP tree against the recursive layout counting leaves per vertex, and ITree::SwapRoot
+    void RadialTree(const Datasets&);
+
+    // Frame time of Clusters::Update against the rebuild of every inter edge it replaced, at rest and while dragging
+    void ClusterFrames(const Datasets&);
+
+    // IStructure::UpdateEdges with the dirty nodes against the rebuild of every edge it replaced
+    void EdgeUpdates(const Datasets&);
+#endif // DATAVIS_BENCHMARKS
+} // namespace Benchmark
+} // namespace DataVis
@@ -53,22 +53,38 @@ namespace Parser
 //--------------------------------------------------------------
 // Attributes
 //--------------------------------------------------------------
-void Attributes::Init(Model::Attributes& _attributes)
+namespace
 {
-    for (auto& it = _attributes.begin(); it != _attributes.end(); it++)
+    // Numbers are stored as float, everything else as string
+    AnyType ToAnyType(const std::string& _value)
     {
         try
         {
-            float value = std::stof(it->second);
-            map.insert({it->first, value});
+            return std::stof(_value);
         }
         catch (std::exception&)
         {
-            map.insert({it->first, it->second});
+            return _value;
         }
     }
 }
 
+void Attributes::Init(Model::Attributes& _attributes)
+{
+    for (auto& it = _attributes.begin(); it != _attributes.end(); it++)
+    {
+        map.insert({it->first, ToAnyType(it->second)});
+    }
+}
+
+void Attributes::Init(const std::vector<std::pair<std::string_view, std::string_view>>& _attributes)
+{
+    for (const auto& [key, value] : _attributes)
+    {
+        map.insert({std::string(key), ToAnyType(std::string(value))});
+    }
+}
+
 float Attributes::FindFloat(const std::string& _key, float _default)
 {
     if (const auto& it = map.find(_key); it != map.end())
@@ -91,6 +107,11 @@ std::string Attributes::FindString(const std::string& _key)
 //--------------------------------------------------------------
 // Dataset
 //--------------------------------------------------------------
+Dataset::Dataset()
+{
+    m_distance_cache = std::make_shared<DistanceCache>();
+}
+
 Dataset::Dataset(const Dataset& _dataset)
 {
     *this = _dataset;
@@ -103,6 +124,8 @@ Dataset& Dataset::operator=(const Dataset& _dataset)
     m_info = _dataset.m_info;
     m_info_idx = _dataset.m_info_idx;
     m_kind = _dataset.m_kind;
+    m_version = _dataset.m_version;
+    m_distance_cache = std::make_shared<DistanceCache>();
     m_vertex_idx = _dataset.m_vertex_idx;
     uint size = _dataset.vertices.size();
     vertices.resize(size);
@@ -111,6 +134,7 @@ Dataset& Dataset::operator=(const Dataset& _dataset)
         vertices[i] = std::make_shared<Vertex>(*_dataset.vertices[i]);        
     }
     edges = _dataset.edges;
+    m_adjacency = _dataset.m_adjacency;
     return *this;
 }
 
@@ -132,7 +156,20 @@ void Dataset::Load(const Model::MainGraph& _graph, const std::string& _filename)
     if (_graph.kind == Model::GraphKind::directed)
         m_kind = Kind::Directed;
     Convert(_graph);
+    BuildAdjacency();
+    SetInfo();
+    IncrementVersion();
+}
+
+void Dataset::Load(const Parser::DotGraph& _graph, const std::string& _filename)
+{
+    m_id = _graph.id;
+    m_filename = _filename;
+    m_kind = _graph.directed ? Kind::Directed : Kind::Undirected;
+    Convert(_graph);
+    BuildAdjacency();
     SetInfo();
+    IncrementVersion();
 }
 
 void Dataset::Load(const std::string& id, const std::string& filename, const Kind& _kind)
@@ -140,6 +177,7 @@ void Dataset::Load(const std::string& id, const std::string& filename, const Kin
     m_id = id;
     m_filename = filename;
     m_kind = _kind;
+    IncrementVersion();
 }
 
 void Dataset::Convert(const Model::MainGraph& _graph)
@@ -164,16 +202,91 @@ void Dataset::Convert(const Model::MainGraph& _graph)
         e.to_idx = v_to_idx;
         const int edge_idx = edges.size() - 1;
         e.idx = edge_idx;
+    }
+}
 
-        vertices[v_from_idx]->outgoing_neighbors.emplace_back(v_to_idx, edge_idx);
-        vertices[v_to_idx]->incoming_neighbors.emplace_back(v_from_idx, edge_idx);
+void Dataset::Convert(const Parser::DotGraph& _graph)
+{
+    vertices.reserve(_graph.nodes.size());
+    for (auto& node : _graph.nodes)
+    {
+        auto& v = *vertices.emplace_back(std::make_shared<Vertex>());
+        v.id = node.id;
+        v.idx = vertices.size() - 1;
+        v.attributes.Init(node.attributes);
+        m_vertex_idx.emplace(v.id, vertices.size() - 1);
+    }
 
-        if (m_kind == Kind::Undirected)
-        {
-            vertices[v_to_idx]->outgoing_neighbors.emplace_back(v_from_idx, edge_idx);
-            vertices[v_from_idx]->incoming_neighbors.emplace_back(v_to_idx, edge_idx);            
-        }
+    // Nodes and edges are already indexed by the parser
+    edges.reserve(_graph.edges.size());
+    for (auto& edge : _graph.edges)
+    {
+        auto& e = edges.emplace_back();
+        e.attributes.Init(edge.attributes);
+        e.from_idx = edge.from;
+        e.to_idx = edge.to;
+        e.idx = edges.size() - 1;
+    }
+}
+
+void Dataset::Load(Snapshot::Reader& _reader, const std::string& _filename)
+{
+    m_filename = _filename;
+    ReadSnapshot(_reader);
+    SetInfo();
+    IncrementVersion();
+}
+
+void Dataset::WriteSnapshot(Snapshot::Writer& _writer) const
+{
+    _writer.WriteString(m_id);
+    _writer.Write<uint8_t>(m_kind == Kind::Directed);
+
+    _writer.Write<uint64_t>(vertices.size());
+    std::vector<VertexIdx> idx(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        _writer.WriteString(vertices[i]->id);
+        _writer.WriteString(vertices[i]->owner);
+        idx[i] = vertices[i]->idx;
     }
+    _writer.WriteArray(idx);
+    Snapshot::WriteAttributes(_writer, vertices.size(), [&](size_t i) -> const Attributes& { return vertices[i]->attributes; });
+
+    Snapshot::WriteEdges(_writer, edges);
+    m_adjacency.Write(_writer);
+}
+
+void Dataset::ReadSnapshot(Snapshot::Reader& _reader)
+{
+    m_id = _reader.ReadString();
+    m_kind = _reader.Read<uint8_t>() ? Kind::Directed : Kind::Undirected;
+
+    // All vertices live in one block, the shared pointers alias into it
+    const size_t count = _reader.Read<uint64_t>();
+    auto block = std::make_shared<std::vector<Vertex>>(count);
+    vertices.resize(count);
+    m_vertex_idx.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        auto& v = (*block)[i];
+        v.id = _reader.ReadString();
+        v.owner = _reader.ReadString();
+        vertices[i] = std::shared_ptr<Vertex>(block, &v);
+        m_vertex_idx.emplace(v.id, i);
+    }
+    std::vector<VertexIdx> idx;
+    _reader.ReadArray(idx);
+    if (idx.size() != count)
+        throw std::runtime_error("vertex columns have different sizes");
+    for (size_t i = 0; i < count; i++)
+        vertices[i]->idx = idx[i];
+    Snapshot::ReadAttributes(_reader, count, [&](size_t i) -> Attributes& { return vertices[i]->attributes; });
+
+    Snapshot::ReadEdges(_reader, edges, count);
+    m_adjacency.Read(_reader);
+    if (m_adjacency.Size() != count)
+        throw std::runtime_error("adjacency does not match the vertices");
 }
 
 void Dataset::InfoGui()
@@ -198,6 +311,13 @@ void Dataset::InfoGui()
                 ImGui::TableNextColumn();
                 ImGui::Text(v.c_str());
             }
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::PushStyleColor(ImGuiCol_Text, IM_COL32(123, 123, 123, 255));
+            ImGui::Text("distance cache");
+            ImGui::PopStyleColor();
+            ImGui::TableNextColumn();
+            ImGui::Text("%u hits, %u misses", m_distance_cache->Hits(), m_distance_cache->Misses());
             ImGui::EndTable();
         }
         ImGui::PopStyleVar();
@@ -218,6 +338,43 @@ const Dataset::Kind& Dataset::GetKind() const
     return m_kind;
 }
 
+void Dataset::IncrementVersion()
+{
+    m_version++;
+}
+
+uint Dataset::GetVersion() const
+{
+    return m_version;
+}
+
+DistanceCache& Dataset::GetDistanceCache() const
+{
+    return *m_distance_cache;
+}
+
+void Dataset::BuildAdjacency()
+{
+    m_adjacency.Build(edges, vertices.size(), m_kind == Kind::Undirected);
+}
+
+const Adjacency& Dataset::GetAdjacency() const
+{
+    return m_adjacency;
+}
+
+void Dataset::BuildNeighborLists()
+{
+    for (int i = 0; i < vertices.size(); i++)
+    {
+        auto& v = *vertices[i];
+        const auto outgoing = m_adjacency.Outgoing(i);
+        const auto incoming = m_adjacency.Incoming(i);
+        v.outgoing_neighbors.assign(outgoing.begin(), outgoing.end());
+        v.incoming_neighbors.assign(incoming.begin(), incoming.end());
+    }
+}
+
 void Dataset::AddInfo(const std::string& _key, const std::string& _value)
 {
     int& stored_val = m_info_idx[_key];
@@ -230,6 +387,167 @@ void Dataset::AddInfo(const std::string& _key, const std::string& _value)
     m_info.emplace_back(_key, _value);
 }
 
+//--------------------------------------------------------------
+// Adjacency
+//--------------------------------------------------------------
+void Adjacency::Direction::Resize(size_t _vertex_count, size_t _neighbor_count)
+{
+    offsets.assign(_vertex_count + 1, 0);
+    idx.resize(_neighbor_count);
+    edge_idx.resize(_neighbor_count);
+}
+
+Adjacency::Neighbors Adjacency::Direction::Get(VertexIdx _v) const
+{
+    return { idx.data() + offsets[_v], edge_idx.data() + offsets[_v], offsets[_v + 1] - offsets[_v] };
+}
+
+void Adjacency::Build(const std::vector<Edge>& _edges, size_t _vertex_count, bool _undirected)
+{
+    const size_t count = _undirected ? 2 * _edges.size() : _edges.size();
+    m_outgoing.Resize(_vertex_count, count);
+    m_incoming.Resize(_vertex_count, count);
+
+    // Count the degrees, then turn them into offsets
+    for (const auto& edge : _edges)
+    {
+        m_outgoing.offsets[edge.from_idx + 1]++;
+        m_incoming.offsets[edge.to_idx + 1]++;
+        if (!_undirected) continue;
+        m_outgoing.offsets[edge.to_idx + 1]++;
+        m_incoming.offsets[edge.from_idx + 1]++;
+    }
+    for (size_t i = 0; i < _vertex_count; i++)
+    {
+        m_outgoing.offsets[i + 1] += m_outgoing.offsets[i];
+        m_incoming.offsets[i + 1] += m_incoming.offsets[i];
+    }
+
+    // Fill in edge order, so every range is ordered the same as the old neighbor lists
+    std::vector<int> out_fill(m_outgoing.offsets.begin(), m_outgoing.offsets.end() - 1);
+    std::vector<int> in_fill(m_incoming.offsets.begin(), m_incoming.offsets.end() - 1);
+    auto add = [&](VertexIdx _from, VertexIdx _to, EdgeIdx _edge)
+    {
+        m_outgoing.idx[out_fill[_from]] = _to;
+        m_outgoing.edge_idx[out_fill[_from]++] = _edge;
+        m_incoming.idx[in_fill[_to]] = _from;
+        m_incoming.edge_idx[in_fill[_to]++] = _edge;
+    };
+    for (int e = 0; e < _edges.size(); e++)
+    {
+        const auto& edge = _edges[e];
+        add(edge.from_idx, edge.to_idx, e);
+        if (_undirected)
+            add(edge.to_idx, edge.from_idx, e);
+    }
+}
+
+void Adjacency::Build(const std::vector<VertexIdx>& _from, const std::vector<VertexIdx>& _to, size_t _vertex_count)
+{
+    size_t count = 0;
+    for (size_t e = 0; e < _from.size(); e++)
+        if (_from[e] != _to[e]) count++;
+    m_outgoing.Resize(_vertex_count, count);
+    m_incoming.Resize(_vertex_count, count);
+
+    for (size_t e = 0; e < _from.size(); e++)
+    {
+        if (_from[e] == _to[e]) continue;
+        m_outgoing.offsets[_from[e] + 1]++;
+        m_incoming.offsets[_to[e] + 1]++;
+    }
+    for (size_t i = 0; i < _vertex_count; i++)
+    {
+        m_outgoing.offsets[i + 1] += m_outgoing.offsets[i];
+        m_incoming.offsets[i + 1] += m_incoming.offsets[i];
+    }
+
+    std::vector<int> out_fill(m_outgoing.offsets.begin(), m_outgoing.offsets.end() - 1);
+    std::vector<int> in_fill(m_incoming.offsets.begin(), m_incoming.offsets.end() - 1);
+    for (int e = 0; e < static_cast<int>(_from.size()); e++)
+    {
+        const VertexIdx from = _from[e], to = _to[e];
+        if (from == to) continue;
+        m_outgoing.idx[out_fill[from]] = to;
+        m_outgoing.edge_idx[out_fill[from]++] = e;
+        m_incoming.idx[in_fill[to]] = from;
+        m_incoming.edge_idx[in_fill[to]++] = e;
+    }
+}
+
+void Adjacency::Build(const std::vector<std::shared_ptr<Vertex>>& _vertices)
+{
+    size_t out_count = 0, in_count = 0;
+    for (const auto& v : _vertices)
+    {
+        out_count += v->outgoing_neighbors.size();
+        in_count += v->incoming_neighbors.size();
+    }
+    m_outgoing.Resize(_vertices.size(), out_count);
+    m_incoming.Resize(_vertices.size(), in_count);
+
+    auto fill = [](Direction& _direction, size_t _i, const std::vector<Neighbor>& _neighbors)
+    {
+        int offset = _direction.offsets[_i];
+        for (const auto& neighbor : _neighbors)
+        {
+            _direction.idx[offset] = neighbor.idx;
+            _direction.edge_idx[offset++] = neighbor.edge_idx;
+        }
+        _direction.offsets[_i + 1] = offset;
+    };
+    for (size_t i = 0; i < _vertices.size(); i++)
+    {
+        fill(m_outgoing, i, _vertices[i]->outgoing_neighbors);
+        fill(m_incoming, i, _vertices[i]->incoming_neighbors);
+    }
+}
+
+Adjacency::Neighbors Adjacency::Outgoing(VertexIdx _v) const
+{
+    return m_outgoing.Get(_v);
+}
+
+Adjacency::Neighbors Adjacency::Incoming(VertexIdx _v) const
+{
+    return m_incoming.Get(_v);
+}
+
+size_t Adjacency::Size() const
+{
+    return m_outgoing.offsets.empty() ? 0 : m_outgoing.offsets.size() - 1;
+}
+
+void Adjacency::Direction::Write(Snapshot::Writer& _writer) const
+{
+    _writer.WriteArray(offsets);
+    _writer.WriteArray(idx);
+    _writer.WriteArray(edge_idx);
+}
+
+void Adjacency::Direction::Read(Snapshot::Reader& _reader)
+{
+    _reader.ReadArray(offsets);
+    _reader.ReadArray(idx);
+    _reader.ReadArray(edge_idx);
+    if (offsets.empty() || idx.size() != edge_idx.size() || static_cast<size_t>(offsets.back()) != idx.size())
+        throw std::runtime_error("adjacency is inconsistent");
+}
+
+void Adjacency::Write(Snapshot::Writer& _writer) const
+{
+    m_outgoing.Write(_writer);
+    m_incoming.Write(_writer);
+}
+
+void Adjacency::Read(Snapshot::Reader& _reader)
+{
+    m_outgoing.Read(_reader);
+    m_incoming.Read(_reader);
+    if (m_outgoing.offsets.size() != m_incoming.offsets.size())
+        throw std::runtime_error("adjacency is inconsistent");
+}
+
 //--------------------------------------------------------------
 // DatasetClusters
 //--------------------------------------------------------------
@@ -279,15 +597,6 @@ void ClusterDataset::Convert(const Model::MainGraph& _graph)
             e.to_idx = vertex_to.idx;
             const int edge_idx = cluster.edges.size() - 1;
             e.idx = edge_idx;
-
-            vertices[v_from_idx]->outgoing_neighbors.emplace_back(vertex_to.idx, edge_idx);
-            vertices[v_to_idx]->incoming_neighbors.emplace_back(vertex_from.idx, edge_idx);
-
-            if (m_kind == Kind::Undirected)
-            {
-                vertices[v_to_idx]->outgoing_neighbors.emplace_back(vertex_from.idx, edge_idx);
-                vertices[v_from_idx]->incoming_neighbors.emplace_back(vertex_to.idx, edge_idx);            
-            }
         }
         else
         {
@@ -299,6 +608,107 @@ void ClusterDataset::Convert(const Model::MainGraph& _graph)
             e.idx = edge_idx;
         }
     }
+
+    for (const auto& cluster : clusters)
+        cluster->BuildAdjacency();
+}
+
+void ClusterDataset::Convert(const Parser::DotGraph& _graph)
+{
+    // Create clusters
+    for (const auto& id : _graph.clusters)
+    {
+        clusters.emplace_back(std::make_shared<Dataset>());
+        m_cluster_idx.emplace(id, clusters.size() - 1);
+        clusters.back()->Load(std::string(id), m_filename, m_kind);
+    }
+
+    // Create vertices
+    for (auto& node : _graph.nodes)
+    {
+        auto& cluster = *clusters[m_cluster_idx[std::string(node.owner)]];
+        // Create vertex
+        cluster.vertices.emplace_back(std::make_shared<Vertex>());
+        auto& v = cluster.vertices.back();
+        v->id = node.id;
+        v->owner = node.owner;
+        v->idx = cluster.vertices.size() - 1;
+        v->attributes.Init(node.attributes);
+        // Add vertex to global vertices
+        vertices.emplace_back(v);
+        m_vertex_idx.emplace(v->id, vertices.size() - 1);
+    }
+
+    // Create edges
+    for (auto& edge : _graph.edges)
+    {
+        const auto& vertex_from = *vertices[edge.from];
+        const auto& vertex_to = *vertices[edge.to];
+
+        if (vertex_from.owner == vertex_to.owner)
+        {
+            auto& cluster = *clusters[m_cluster_idx[vertex_from.owner]];
+            auto& e = cluster.edges.emplace_back();
+            e.attributes.Init(edge.attributes);
+            e.from_idx = vertex_from.idx;
+            e.to_idx = vertex_to.idx;
+            e.idx = cluster.edges.size() - 1;
+        }
+        else
+        {
+            auto& e = edges.emplace_back();
+            e.attributes.Init(edge.attributes);
+            e.from_idx = edge.from;
+            e.to_idx = edge.to;
+            e.idx = edges.size() - 1;
+        }
+    }
+
+    for (const auto& cluster : clusters)
+        cluster->BuildAdjacency();
+}
+
+void ClusterDataset::WriteSnapshot(Snapshot::Writer& _writer) const
+{
+    Dataset::WriteSnapshot(_writer);
+    _writer.Write<uint64_t>(clusters.size());
+    std::vector<VertexIdx> global;
+    for (const auto& cluster : clusters)
+    {
+        _writer.WriteString(cluster->GetId());
+        // Cluster vertices are shared with the global vertices
+        global.clear();
+        for (const auto& v : cluster->vertices)
+            global.push_back(m_vertex_idx.at(v->id));
+        _writer.WriteArray(global);
+        Snapshot::WriteEdges(_writer, cluster->edges);
+    }
+}
+
+void ClusterDataset::ReadSnapshot(Snapshot::Reader& _reader)
+{
+    Dataset::ReadSnapshot(_reader);
+    const size_t count = _reader.Read<uint64_t>();
+    std::vector<VertexIdx> global;
+    for (size_t c = 0; c < count; c++)
+    {
+        const std::string id(_reader.ReadString());
+        clusters.emplace_back(std::make_shared<Dataset>());
+        m_cluster_idx.emplace(id, clusters.size() - 1);
+        auto& cluster = *clusters.back();
+        cluster.Load(id, m_filename, m_kind);
+
+        _reader.ReadArray(global);
+        cluster.vertices.reserve(global.size());
+        for (const VertexIdx v : global)
+        {
+            if (v < 0 || static_cast<size_t>(v) >= vertices.size())
+                throw std::runtime_error("cluster vertex out of range");
+            cluster.vertices.push_back(vertices[v]);
+        }
+        Snapshot::ReadEdges(_reader, cluster.edges, cluster.vertices.size());
+        cluster.BuildAdjacency();
+    }
 }
 
 void ClusterDataset::SetInfo()
@@ -7,9 +7,16 @@ namespace DataVis
 //--------------------------------------------------------------
 namespace Parser
 {
+    struct DotGraph;
     bool DotFile( const std::string& filename, Model::MainGraph& );
 };
 
+namespace Snapshot
+{
+    class Writer;
+    class Reader;
+}
+
 //--------------------------------------------------------------
 using AnyType = std::variant<float, std::string>;
 
@@ -39,6 +46,7 @@ struct Attributes
 {
     Attributes() = default;
     void Init(Model::Attributes& _attributes);
+    void Init(const std::vector<std::pair<std::string_view, std::string_view>>& attributes);
     std::unordered_map<Model::Id, AnyType> map;
     float FindFloat(const std::string& key, float default_value = 1.f);
     std::string FindString(const std::string& key);
@@ -52,7 +60,6 @@ using EdgeIdx = int;
 
 constexpr int VISITED_IDX = -1;
 constexpr int UNINIT_IDX = -1;
-constexpr const char* DUMMY_ID = "dummy";
 constexpr int REMOVE_IDX = -3;
 
 //--------------------------------------------------------------
@@ -74,7 +81,8 @@ struct Vertex
     std::string id;
     std::string owner;
     VertexIdx idx = MIN_INT;
-    /// A neighbor is made out of a vertex index and a edge index
+    /// A neighbor is made out of a vertex index and a edge index.
+    /// Only filled by Dataset::BuildNeighborLists, read-only code should use Dataset::GetAdjacency
     std::vector<Neighbor> outgoing_neighbors;
     std::vector<Neighbor> incoming_neighbors;
     Attributes attributes;
@@ -89,31 +97,129 @@ struct Edge
     Attributes attributes;
 };
 
+//--------------------------------------------------------------
+// Adjacency
+//--------------------------------------------------------------
+/**
+ * Read-only compressed sparse row view of the neighbors of every vertex.
+ * The neighbors of vertex v are stored contiguously in [offsets[v], offsets[v + 1]),
+ * in the same order as Dataset::Convert fills Vertex::outgoing_neighbors and Vertex::incoming_neighbors.
+ */
+class Adjacency
+{
+public:
+    // Range over the neighbors of a single vertex
+    class Neighbors
+    {
+    public:
+        class Iterator
+        {
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = Neighbor;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const Neighbor*;
+            using reference = Neighbor;
+
+            Iterator(const VertexIdx* _idx, const EdgeIdx* _edge_idx) : m_idx(_idx), m_edge_idx(_edge_idx) {}
+            Neighbor operator*() const { return { *m_idx, *m_edge_idx }; }
+            Iterator& operator++() { m_idx++; m_edge_idx++; return *this; }
+            bool operator==(const Iterator& _other) const { return m_idx == _other.m_idx; }
+            bool operator!=(const Iterator& _other) const { return m_idx != _other.m_idx; }
+
+        private:
+            const VertexIdx* m_idx;
+            const EdgeIdx* m_edge_idx;
+        };
+
+        Neighbors(const VertexIdx* _idx, const EdgeIdx* _edge_idx, int _size) : m_idx(_idx), m_edge_idx(_edge_idx), m_size(_size) {}
+        [[nodiscard]] Iterator begin() const { return { m_idx, m_edge_idx }; }
+        [[nodiscard]] Iterator end() const { return { m_idx + m_size, m_edge_idx + m_size }; }
+        [[nodiscard]] Neighbor operator[](int _i) const { return { m_idx[_i], m_edge_idx[_i] }; }
+        [[nodiscard]] int size() const { return m_size; }
+        [[nodiscard]] bool empty() const { return m_size == 0; }
+
+    private:
+        const VertexIdx* m_idx;
+        const EdgeIdx* m_edge_idx;
+        int m_size;
+    };
+
+    Adjacency() = default;
+    // Undirected edges are stored in both directions
+    void Build(const std::vector<Edge>& edges, size_t vertex_count, bool undirected);
+    // Directed edge i from from[i] to to[i], self loops are left out
+    void Build(const std::vector<VertexIdx>& from, const std::vector<VertexIdx>& to, size_t vertex_count);
+    // Snapshot of the neighbor lists of the vertices
+    void Build(const std::vector<std::shared_ptr<Vertex>>& vertices);
+    [[nodiscard]] Neighbors Outgoing(VertexIdx) const;
+    [[nodiscard]] Neighbors Incoming(VertexIdx) const;
+    [[nodiscard]] size_t Size() const;
+    void Write(Snapshot::Writer&) const;
+    void Read(Snapshot::Reader&);
+
+private:
+    struct Direction
+    {
+        std::vector<int> offsets;
+        std::vector<VertexIdx> idx;
+        std::vector<EdgeIdx> edge_idx;
+        void Resize(size_t vertex_count, size_t neighbor_count);
+        [[nodiscard]] Neighbors Get(VertexIdx) const;
+        void Write(Snapshot::Writer&) const;
+        void Read(Snapshot::Reader&);
+    };
+    Direction m_outgoing;
+    Direction m_incoming;
+};
+
+class DistanceCache;
+
 class Dataset
 {
 public:
     enum class Kind { Undirected, Directed };
 
-    Dataset() = default;
+    Dataset();
     virtual ~Dataset() = default;
     Dataset(const Dataset&);
     Dataset& operator=(const Dataset&);
     const std::string& GetId();
     const std::string& GetFilename();
     void Load( const Model::MainGraph&, const std::string& filename );
+    // Same as above, filled from the result of Parser::FastDotFile
+    void Load( const Parser::DotGraph&, const std::string& filename );
     // This overload assumes you will update the vertices and edges manually
     void Load( const std::string& id, const std::string& filename, const Kind&);
+    // Same as above, filled from a snapshot written by WriteSnapshot, see Snapshot::Load
+    void Load( Snapshot::Reader&, const std::string& filename );
+    virtual void WriteSnapshot( Snapshot::Writer& ) const;
     void InfoGui();
     [[nodiscard]] const Kind& GetKind() const;
     void AddInfo(const std::string& key, const std::string& value);
+    // Bump after changing vertices or edges, invalidates derived data such as the distance cache
+    void IncrementVersion();
+    [[nodiscard]] uint GetVersion() const;
+    [[nodiscard]] DistanceCache& GetDistanceCache() const;
+    // Rebuilds the adjacency from the edges, Load calls this for you
+    void BuildAdjacency();
+    [[nodiscard]] const Adjacency& GetAdjacency() const;
+    // Fills the neighbor lists of the vertices from the adjacency, for algorithms that edit them in place
+    void BuildNeighborLists();
 
     std::vector<std::shared_ptr<Vertex>> vertices;
     std::vector<Edge> edges;
 
 protected:
     virtual void Convert( const Model::MainGraph& );
+    virtual void Convert( const Parser::DotGraph& );
+    virtual void ReadSnapshot( Snapshot::Reader& );
     virtual void SetInfo();
     Kind m_kind = Kind::Undirected;
+    uint m_version = 0;
+    // Not copied along with the dataset, a copy gets its own cache
+    std::shared_ptr<DistanceCache> m_distance_cache;
+    Adjacency m_adjacency;
     std::string m_id;
     std::string m_filename;
 
@@ -134,9 +240,12 @@ class ClusterDataset final : public Dataset
 {
 public:
     std::vector<std::shared_ptr<Dataset>> clusters;
+    void WriteSnapshot( Snapshot::Writer& ) const override;
 
 protected:
     void Convert( const Model::MainGraph& ) override;
+    void Convert( const Parser::DotGraph& ) override;
+    void ReadSnapshot( Snapshot::Reader& ) override;
     void SetInfo( ) override;
 
     std::unordered_map<std::string, uint> m_cluster_idx;
@@ -0,0 +1,102 @@
+#include "precomp.h"
+
+namespace DataVis
+{
+DatasetLoader::~DatasetLoader()
+{
+    for (const auto& dataset : m_datasets)
+        dataset.wait();
+}
+
+void DatasetLoader::Scan()
+{
+    const std::string data_path = ofToDataPath("", false);
+    for (const auto& entry : std::filesystem::directory_iterator(data_path))
+    {
+        if (entry.path().extension() != ".dot") continue;
+        const std::string filename = entry.path().filename().string();
+        m_filenames.push_back(filename);
+        m_datasets.push_back(ThreadPool::Global().Submit([filename]() { return Load(filename); }).share());
+    }
+}
+
+size_t DatasetLoader::Size() const
+{
+    return m_filenames.size();
+}
+
+bool DatasetLoader::Empty() const
+{
+    return m_filenames.empty();
+}
+
+const std::string& DatasetLoader::GetFilename(size_t _i) const
+{
+    return m_filenames[_i];
+}
+
+const std::vector<std::string>& DatasetLoader::GetFilenames() const
+{
+    return m_filenames;
+}
+
+DatasetLoader::State DatasetLoader::GetState(size_t _i) const
+{
+    if (m_datasets[_i].wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return State::Loading;
+    return m_datasets[_i].get() ? State::Loaded : State::Failed;
+}
+
+size_t DatasetLoader::LoadedCount() const
+{
+    size_t count = 0;
+    for (size_t i = 0; i < m_datasets.size(); i++)
+        count += GetState(i) != State::Loading;
+    return count;
+}
+
+std::shared_ptr<Dataset> DatasetLoader::Get(size_t _i)
+{
+    return m_datasets[_i].get();
+}
+
+std::vector<std::shared_ptr<Dataset>> DatasetLoader::GetAll()
+{
+    std::vector<std::shared_ptr<Dataset>> datasets;
+    for (size_t i = 0; i < m_datasets.size(); i++)
+        if (auto dataset = Get(i))
+            datasets.push_back(std::move(dataset));
+    return datasets;
+}
+
+std::shared_ptr<Dataset> DatasetLoader::Load(const std::string& _filename)
+{
+    try
+    {
+        // A snapshot that is up to date with the file skips parsing altogether
+        if (auto dataset = Snapshot::Load(_filename))
+            return dataset;
+
+        // The fast parser covers the files in bin/data, Spirit handles the rest of the DOT language
+        std::shared_ptr<Dataset> dataset;
+        if (Parser::DotGraph graph; Parser::FastDotFile(_filename, graph))
+        {
+            dataset = graph.clusters.empty() ? std::make_shared<Dataset>() : std::make_shared<ClusterDataset>();
+            dataset->Load(graph, _filename);
+        }
+        else if (Model::MainGraph graph; Parser::DotFile(_filename, graph))
+        {
+            dataset = graph.graph.subgraphs.empty() ? std::make_shared<Dataset>() : std::make_shared<ClusterDataset>();
+            dataset->Load(graph, _filename);
+        }
+        if (dataset)
+            Snapshot::Save(*dataset, _filename);
+        return dataset;
+    }
+    catch (std::exception& e)
+    {
+        std::cout << "W/DatasetLoader::Load: Failed to load " << _filename << ": " << e.what() << std::endl;
+        return nullptr;
+    }
+}
+} // namespace DataVis
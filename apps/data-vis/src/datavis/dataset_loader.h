@@ -0,0 +1,43 @@
+#pragma once
+
+namespace DataVis
+{
+//--------------------------------------------------------------
+// Dataset Loader
+//--------------------------------------------------------------
+/**
+ * Registers every .dot file in a folder right away and loads the datasets on the global thread pool,
+ * so startup does not wait for parsing. Only Get waits, and only for the dataset it is asked for.
+ */
+class DatasetLoader
+{
+public:
+    enum class State { Loading, Loaded, Failed };
+
+    DatasetLoader() = default;
+    DatasetLoader(const DatasetLoader&) = delete;
+    DatasetLoader& operator=(const DatasetLoader&) = delete;
+    // Waits for the loads that are still running
+    ~DatasetLoader();
+
+    // Adds the .dot files in the data folder and starts loading them in parallel
+    void Scan();
+    [[nodiscard]] size_t Size() const;
+    [[nodiscard]] bool Empty() const;
+    [[nodiscard]] const std::string& GetFilename(size_t) const;
+    [[nodiscard]] const std::vector<std::string>& GetFilenames() const;
+    [[nodiscard]] State GetState(size_t) const;
+    [[nodiscard]] size_t LoadedCount() const;
+    // Blocks until the dataset is loaded, null when it failed to load
+    [[nodiscard]] std::shared_ptr<Dataset> Get(size_t);
+    // Blocks until everything is loaded, leaves out the datasets that failed
+    [[nodiscard]] std::vector<std::shared_ptr<Dataset>> GetAll();
+
+    // Snapshot, then the fast parser, then Spirit. Writes a snapshot after parsing
+    static std::shared_ptr<Dataset> Load(const std::string& filename);
+
+private:
+    std::vector<std::string> m_filenames;
+    std::vector<std::shared_future<std::shared_ptr<Dataset>>> m_datasets;
+};
+} // namespace DataVis
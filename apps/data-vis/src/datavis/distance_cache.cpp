@@ -0,0 +1,115 @@
+#include "precomp.h"
+
+namespace DataVis
+{
+//--------------------------------------------------------------
+// Distance Cache
+//--------------------------------------------------------------
+std::shared_ptr<const DistanceCache::Matrix> DistanceCache::GetMatrix(const Dataset& _dataset)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_matrix && m_matrix_version == _dataset.GetVersion())
+    {
+        m_hits++;
+        return m_matrix;
+    }
+
+    m_misses++;
+    std::unique_ptr<Matrix> D;
+    ShortestPaths::AllPairs(_dataset, D);
+    m_matrix = std::move(D);
+    m_matrix_version = _dataset.GetVersion();
+    return m_matrix;
+}
+
+//--------------------------------------------------------------
+double DistanceCache::Distance(const Matrix& _D, int _i, int _j)
+{
+    return const_cast<Matrix&>(_D).get(_i, _j);
+}
+
+//--------------------------------------------------------------
+std::shared_ptr<const DistanceCache::NeighborList> DistanceCache::GetNeighbors(const Dataset& _dataset)
+{
+    // The neighbor lists are sorted rows of the matrix, so they never need their own search
+    const auto D = GetMatrix(_dataset);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_neighbors && m_neighbors_version == _dataset.GetVersion())
+    {
+        m_hits++;
+        return m_neighbors;
+    }
+
+    m_misses++;
+
+    const int size = _dataset.vertices.size();
+    auto neighbors = std::make_shared<NeighborList>(size);
+    ThreadPool::Global().ParallelFor(0, size, [&](int i)
+    {
+        // Leave out itself and sort in increasing distance
+        auto& entry = (*neighbors)[i];
+        entry.reserve(size - 1);
+        for (int j = 0; j < size; j++)
+        {
+            if (i == j) continue;
+            entry.emplace_back(j, Distance(*D, i, j));
+        }
+        std::sort(entry.begin(), entry.end(), [](const std::pair<int, double>& lhs, const std::pair<int, double>& rhs) {
+            return lhs.second < rhs.second;
+        });
+    });
+    m_neighbors = std::move(neighbors);
+    m_neighbors_version = _dataset.GetVersion();
+    return m_neighbors;
+}
+
+//--------------------------------------------------------------
+std::shared_ptr<const DistanceCache::Ranks> DistanceCache::GetRanks(const Dataset& _dataset)
+{
+    // Inverts the neighbor lists, the rank of a vertex is a lookup instead of a search
+    const auto neighbors = GetNeighbors(_dataset);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_ranks && m_ranks_version == _dataset.GetVersion())
+    {
+        m_hits++;
+        return m_ranks;
+    }
+
+    m_misses++;
+
+    const int size = _dataset.vertices.size();
+    auto ranks = std::make_shared<Ranks>(size);
+    ThreadPool::Global().ParallelFor(0, size, [&](int i)
+    {
+        auto& entry = (*ranks)[i];
+        entry.assign(size, -1);
+        const auto& list = (*neighbors)[i];
+        for (int k = 0; k < list.size(); k++)
+            entry[list[k].first] = k;
+    });
+    m_ranks = std::move(ranks);
+    m_ranks_version = _dataset.GetVersion();
+    return m_ranks;
+}
+
+//--------------------------------------------------------------
+void DistanceCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_matrix = nullptr;
+    m_neighbors = nullptr;
+    m_ranks = nullptr;
+}
+
+uint DistanceCache::Hits() const
+{
+    return m_hits;
+}
+
+uint DistanceCache::Misses() const
+{
+    return m_misses;
+}
+} // namespace DataVis
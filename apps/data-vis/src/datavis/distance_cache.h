@@ -0,0 +1,47 @@
+#pragma once
+
+namespace DataVis
+{
+//--------------------------------------------------------------
+// Distance Cache
+//--------------------------------------------------------------
+/**
+ * Keeps the graph-theoretic distances of a single dataset, so the layouts and the quality metrics
+ * share one all pairs shortest paths computation. The cache is recomputed when the version of the
+ * dataset changed since it was filled. Both results are read-only for the callers.
+ */
+class DistanceCache
+{
+public:
+    using Matrix = smat::Matrix<double>;
+    using NeighborList = qdtsne::NeighborList<int, double>;
+    using Ranks = std::vector<std::vector<int>>;
+
+    DistanceCache() = default;
+    // Full distance matrix, read its entries with Distance
+    std::shared_ptr<const Matrix> GetMatrix(const Dataset&);
+    // Distance from vertex i to vertex j, smat::Matrix only has a non-const getter
+    static double Distance(const Matrix&, int i, int j);
+    // Per vertex all other vertices sorted in increasing distance
+    std::shared_ptr<const NeighborList> GetNeighbors(const Dataset&);
+    // Per vertex the position of every other vertex in its neighbor list, -1 for itself
+    std::shared_ptr<const Ranks> GetRanks(const Dataset&);
+    void Clear();
+
+    // Lookups of all three entries. GetNeighbors and GetRanks also count the lookup of the entry they are built from
+    [[nodiscard]] uint Hits() const;
+    [[nodiscard]] uint Misses() const;
+
+private:
+    std::shared_ptr<const Matrix> m_matrix;
+    std::shared_ptr<const NeighborList> m_neighbors;
+    std::shared_ptr<const Ranks> m_ranks;
+    // Version of the dataset the entries were computed for
+    uint m_matrix_version = 0;
+    uint m_neighbors_version = 0;
+    uint m_ranks_version = 0;
+    std::atomic<uint> m_hits = 0;
+    std::atomic<uint> m_misses = 0;
+    std::mutex m_mutex;
+};
+} // namespace DataVis
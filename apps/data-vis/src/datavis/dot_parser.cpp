@@ -0,0 +1,460 @@
+#include "precomp.h"
+
+namespace DataVis
+{
+namespace Parser
+{
+namespace
+{
+    void SetAttribute(DotGraph::Attributes& _attributes, std::string_view _key, std::string_view _value)
+    {
+        for (auto& [key, value] : _attributes)
+        {
+            if (key == _key)
+            {
+                value = _value;
+                return;
+            }
+        }
+        _attributes.emplace_back(_key, _value);
+    }
+
+    void SetAttributes(DotGraph::Attributes& _attributes, const DotGraph::Attributes& _values)
+    {
+        for (const auto& [key, value] : _values)
+            SetAttribute(_attributes, key, value);
+    }
+
+    bool IsIdStart(unsigned char _c)
+    {
+        return std::isalpha(_c) || _c == '_' || _c >= 0x80;
+    }
+
+    bool IsIdChar(unsigned char _c)
+    {
+        return IsIdStart(_c) || std::isdigit(_c);
+    }
+
+    //--------------------------------------------------------------
+    // Recursive descent over the mapped characters, mirrors the grammar of spirit-graphviz
+    class DotReader
+    {
+    public:
+        DotReader(const char* _begin, const char* _end, DotGraph& _graph) :
+            m_begin(_begin), m_it(_begin), m_end(_end), m_graph(_graph)
+        {
+        }
+
+        bool Parse()
+        {
+            m_graph.strict = AcceptKeyword("strict");
+            if (AcceptKeyword("digraph")) m_graph.directed = true;
+            else if (!AcceptKeyword("graph")) return Error("expected graph or digraph");
+
+            Skip();
+            if (m_it != m_end && *m_it != '{' && !ReadId(m_graph.id)) return false;
+
+            Frame main;
+            main.owner = m_graph.id;
+            main.main = true;
+            if (!StmtList(main)) return false;
+            Skip();
+            return m_it == m_end || Error("unexpected input after the graph");
+        }
+
+        [[nodiscard]] const std::string& GetError() const { return m_error; }
+
+    private:
+        struct Frame
+        {
+            std::string_view owner;
+            bool main = false;
+            DotGraph::Attributes node_attributes;
+            DotGraph::Attributes edge_attributes;
+        };
+
+        //--------------------------------------------------------------
+        // Tokens
+        //--------------------------------------------------------------
+        void Skip()
+        {
+            while (m_it != m_end)
+            {
+                if (std::isspace(static_cast<unsigned char>(*m_it)))
+                {
+                    m_it++;
+                }
+                else if (*m_it == '/' && m_it + 1 != m_end && m_it[1] == '/')
+                {
+                    while (m_it != m_end && *m_it != '\n') m_it++;
+                }
+                else if (*m_it == '/' && m_it + 1 != m_end && m_it[1] == '*')
+                {
+                    m_it += 2;
+                    while (m_it + 1 < m_end && !(m_it[0] == '*' && m_it[1] == '/')) m_it++;
+                    m_it = std::min(m_it + 2, m_end);
+                }
+                else return;
+            }
+        }
+
+        bool Peek(char _c)
+        {
+            Skip();
+            return m_it != m_end && *m_it == _c;
+        }
+
+        bool Accept(char _c)
+        {
+            if (!Peek(_c)) return false;
+            m_it++;
+            return true;
+        }
+
+        bool AcceptArrow()
+        {
+            Skip();
+            if (m_end - m_it < 2 || m_it[0] != '-' || m_it[1] != (m_graph.directed ? '>' : '-')) return false;
+            m_it += 2;
+            return true;
+        }
+
+        // Keywords have to be followed by a character that can not continue an id
+        bool PeekKeyword(std::string_view _keyword)
+        {
+            Skip();
+            if (m_end - m_it < static_cast<std::ptrdiff_t>(_keyword.size())) return false;
+            if (std::string_view(m_it, _keyword.size()) != _keyword) return false;
+            const char* next = m_it + _keyword.size();
+            return next == m_end || !IsIdChar(*next);
+        }
+
+        bool AcceptKeyword(std::string_view _keyword)
+        {
+            if (!PeekKeyword(_keyword)) return false;
+            m_it += _keyword.size();
+            return true;
+        }
+
+        bool ReadId(std::string_view& _id)
+        {
+            Skip();
+            if (m_it == m_end) return Error("expected an id");
+            const char* begin = m_it;
+            if (*m_it == '"')
+            {
+                bool escaped = false;
+                for (m_it++; m_it != m_end && *m_it != '"'; m_it++)
+                {
+                    if (*m_it != '\\') continue;
+                    escaped = true;
+                    if (++m_it == m_end) break;
+                }
+                if (m_it == m_end) return Error("unterminated string");
+                _id = std::string_view(begin + 1, m_it - begin - 1);
+                m_it++;
+                if (escaped)
+                {
+                    // A backslash keeps the character after it, same as the Spirit grammar
+                    std::string& unescaped = m_graph.storage.emplace_back();
+                    for (size_t i = 0; i < _id.size(); i++)
+                    {
+                        if (_id[i] == '\\') i++;
+                        unescaped.push_back(_id[i]);
+                    }
+                    _id = unescaped;
+                }
+                return true;
+            }
+            if (IsIdStart(*m_it))
+            {
+                while (m_it != m_end && IsIdChar(*m_it)) m_it++;
+                _id = std::string_view(begin, m_it - begin);
+                return true;
+            }
+
+            // Numeral: [-]( .digits | digits [. digits*] )
+            const char* it = m_it;
+            if (*it == '-') it++;
+            auto digits = [&]()
+            {
+                const char* start = it;
+                while (it != m_end && std::isdigit(static_cast<unsigned char>(*it))) it++;
+                return it != start;
+            };
+            bool valid;
+            if (it != m_end && *it == '.')
+            {
+                it++;
+                valid = digits();
+            }
+            else
+            {
+                valid = digits();
+                if (valid && it != m_end && *it == '.')
+                {
+                    it++;
+                    digits();
+                }
+            }
+            if (!valid) return Error(*m_it == '<' ? "HTML strings are not supported" : "expected an id");
+            m_it = it;
+            _id = std::string_view(begin, m_it - begin);
+            return true;
+        }
+
+        bool Error(const std::string& _message)
+        {
+            m_error = _message;
+            return false;
+        }
+
+        //--------------------------------------------------------------
+        // Grammar
+        //--------------------------------------------------------------
+        bool StmtList(Frame& _frame)
+        {
+            if (!Accept('{')) return Error("expected {");
+            while (!Accept('}'))
+            {
+                if (m_it == m_end) return Error("expected }");
+                if (!Stmt(_frame)) return false;
+                Accept(';');
+            }
+            return true;
+        }
+
+        bool Stmt(Frame& _frame)
+        {
+            if (Peek('{') || PeekKeyword("subgraph"))
+            {
+                if (!Subgraph(_frame)) return false;
+                if (AcceptArrow()) return Error("subgraphs as edge endpoints are not supported");
+                return true;
+            }
+
+            // Attribute statements
+            DotGraph::Attributes* target = nullptr;
+            if (AcceptKeyword("node")) target = &_frame.node_attributes;
+            else if (AcceptKeyword("edge")) target = &_frame.edge_attributes;
+            else if (AcceptKeyword("graph")) target = &m_graph_attributes;
+            if (target)
+            {
+                if (!Peek('[')) return Error("expected an attribute list");
+                return AttrList(*target);
+            }
+
+            std::string_view id;
+            if (!ReadId(id)) return false;
+            // Graph attribute, not used by the datasets
+            if (Accept('='))
+                return ReadId(id);
+            if (!Port()) return false;
+
+            int from = Node(id, _frame);
+            if (!AcceptArrow())
+            {
+                DotGraph::Attributes declared;
+                if (Peek('[') && !AttrList(declared)) return false;
+                SetAttributes(m_graph.nodes[from].attributes, declared);
+                return true;
+            }
+
+            // Edge chain a -> b -> c
+            std::vector<int> path;
+            do
+            {
+                if (Peek('{') || PeekKeyword("subgraph")) return Error("subgraphs as edge endpoints are not supported");
+                if (!ReadId(id) || !Port()) return false;
+                const int to = Node(id, _frame);
+                path.push_back(AddEdge(from, to));
+                from = to;
+            }
+            while (AcceptArrow());
+
+            DotGraph::Attributes declared;
+            if (Peek('[') && !AttrList(declared)) return false;
+            for (const int edge : path)
+            {
+                SetAttributes(m_graph.edges[edge].attributes, _frame.edge_attributes);
+                SetAttributes(m_graph.edges[edge].attributes, declared);
+            }
+            return true;
+        }
+
+        bool Subgraph(Frame& _parent)
+        {
+            Frame frame = _parent;
+            frame.main = false;
+            frame.owner = {};
+            bool named = false;
+            if (AcceptKeyword("subgraph") && !Peek('{'))
+            {
+                if (!ReadId(frame.owner)) return false;
+                named = true;
+            }
+
+            // Named subgraphs are merged, anonymous ones never alias
+            if (_parent.main)
+            {
+                auto& clusters = m_graph.clusters;
+                if (!named || std::find(clusters.begin(), clusters.end(), frame.owner) == clusters.end())
+                    clusters.push_back(frame.owner);
+            }
+            return StmtList(frame);
+        }
+
+        // Ports and compass points are parsed but not used
+        bool Port()
+        {
+            std::string_view port;
+            while (Accept(':'))
+                if (!ReadId(port)) return false;
+            return true;
+        }
+
+        // [a=b, c=d; e=f][...], a key without value extends the previous value, e.g. source=a,b
+        bool AttrList(DotGraph::Attributes& _attributes)
+        {
+            while (Accept('['))
+            {
+                std::string_view key, value;
+                while (!Accept(']'))
+                {
+                    std::string_view id;
+                    if (!ReadId(id)) return false;
+                    if (Accept('='))
+                    {
+                        key = id;
+                        if (!ReadId(value)) return false;
+                    }
+                    else if (key.empty())
+                    {
+                        return Error("expected =");
+                    }
+                    else
+                    {
+                        value = Extend(value, id);
+                    }
+                    SetAttribute(_attributes, key, value);
+                    if (!Accept(',')) Accept(';');
+                }
+            }
+            return true;
+        }
+
+        // Grows the view over the separator when both are unquoted parts of the file, copies otherwise
+        std::string_view Extend(std::string_view _value, std::string_view _id)
+        {
+            const char* value_end = _value.data() + _value.size();
+            const bool in_file = _value.data() >= m_begin && value_end <= _id.data() && _id.data() < m_end;
+            if (in_file && std::find(value_end, _id.data(), '"') == _id.data())
+                return std::string_view(_value.data(), _id.data() + _id.size() - _value.data());
+            return m_graph.storage.emplace_back(std::string(_value) + "," + std::string(_id));
+        }
+
+        int Node(std::string_view _id, const Frame& _frame)
+        {
+            auto [it, inserted] = m_node_idx.emplace(_id, static_cast<int>(m_graph.nodes.size()));
+            if (inserted)
+            {
+                auto& node = m_graph.nodes.emplace_back();
+                node.id = _id;
+                node.owner = _frame.owner;
+            }
+            SetAttributes(m_graph.nodes[it->second].attributes, _frame.node_attributes);
+            return it->second;
+        }
+
+        int AddEdge(int _from, int _to)
+        {
+            if (m_graph.strict)
+            {
+                // Strict graphs merge duplicates, undirected also in the opposite direction
+                auto it = m_edge_idx.find(Key(_from, _to));
+                if (it == m_edge_idx.end() && !m_graph.directed)
+                    it = m_edge_idx.find(Key(_to, _from));
+                if (it != m_edge_idx.end()) return it->second;
+                m_edge_idx.emplace(Key(_from, _to), static_cast<int>(m_graph.edges.size()));
+            }
+            auto& edge = m_graph.edges.emplace_back();
+            edge.from = _from;
+            edge.to = _to;
+            return m_graph.edges.size() - 1;
+        }
+
+        static uint64_t Key(int _from, int _to)
+        {
+            return static_cast<uint64_t>(_from) << 32 | static_cast<uint32_t>(_to);
+        }
+
+        const char* m_begin;
+        const char* m_it;
+        const char* m_end;
+        DotGraph& m_graph;
+        DotGraph::Attributes m_graph_attributes;
+        std::unordered_map<std::string_view, int> m_node_idx;
+        std::unordered_map<uint64_t, int> m_edge_idx;
+        std::string m_error;
+    };
+} // namespace
+
+//--------------------------------------------------------------
+bool FastDotFile(const std::string& _filename, DotGraph& _graph)
+{
+    namespace bip = boost::interprocess;
+    const std::string filepath = ofToDataPath(_filename, false);
+    if (!std::filesystem::exists(filepath))
+    {
+        std::cout << "W/Parser::FastDotFile: File doesn't exists: " << filepath << std::endl;
+        return false;
+    }
+
+    _graph = DotGraph();
+    try
+    {
+        bip::file_mapping file(filepath.c_str(), bip::read_only);
+        _graph.region = std::make_shared<bip::mapped_region>(file, bip::read_only);
+    }
+    catch (bip::interprocess_exception& e)
+    {
+        std::cout << "W/Parser::FastDotFile: Could not map " << filepath << ": " << e.what() << std::endl;
+        return false;
+    }
+    const char* begin = static_cast<const char*>(_graph.region->get_address());
+    const char* end = begin + _graph.region->get_size();
+
+    DotReader reader(begin, end, _graph);
+    if (!reader.Parse())
+    {
+        std::cout << "W/Parser::FastDotFile: " << _filename << ": " << reader.GetError() << std::endl;
+        return false;
+    }
+
+    // Order nodes by id and edges by (from, to), stable for equal keys like the multiset of the model
+    const int size = _graph.nodes.size();
+    std::vector<int> order(size);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](int _a, int _b) { return _graph.nodes[_a].id < _graph.nodes[_b].id; });
+    std::vector<int> rank(size);
+    std::vector<DotGraph::Node> nodes(size);
+    for (int i = 0; i < size; i++)
+    {
+        rank[order[i]] = i;
+        nodes[i] = std::move(_graph.nodes[order[i]]);
+    }
+    _graph.nodes = std::move(nodes);
+    for (auto& edge : _graph.edges)
+    {
+        edge.from = rank[edge.from];
+        edge.to = rank[edge.to];
+    }
+    std::stable_sort(_graph.edges.begin(), _graph.edges.end(), [](const DotGraph::Edge& _a, const DotGraph::Edge& _b)
+    {
+        return std::tie(_a.from, _a.to) < std::tie(_b.from, _b.to);
+    });
+    std::stable_sort(_graph.clusters.begin(), _graph.clusters.end());
+    return true;
+}
+} // namespace Parser
+} // namespace DataVis
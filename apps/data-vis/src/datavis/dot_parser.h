@@ -0,0 +1,56 @@
+#pragma once
+
+namespace DataVis
+{
+namespace Parser
+{
+//--------------------------------------------------------------
+// Fast DOT Parser
+//--------------------------------------------------------------
+/**
+ * Flat result of FastDotFile. Ids and values are views into the memory mapped file,
+ * only quoted strings containing escapes are copied into storage.
+ * Nodes are ordered by id, edges by (from, to) and clusters by id, the same order the
+ * Spirit model iterates in, so both parsers produce identical datasets.
+ */
+struct DotGraph
+{
+    using Attributes = std::vector<std::pair<std::string_view, std::string_view>>;
+
+    struct Node
+    {
+        std::string_view id;
+        // Id of the (sub)graph the node first appeared in
+        std::string_view owner;
+        Attributes attributes;
+    };
+
+    struct Edge
+    {
+        int from = 0;
+        int to = 0;
+        Attributes attributes;
+    };
+
+    bool strict = false;
+    bool directed = false;
+    std::string_view id;
+    std::vector<Node> nodes;
+    std::vector<Edge> edges;
+    // Ids of the subgraphs directly inside the main graph
+    std::vector<std::string_view> clusters;
+
+    // Keep the views valid
+    std::shared_ptr<boost::interprocess::mapped_region> region;
+    std::deque<std::string> storage;
+};
+
+/**
+ * \brief Hand written DOT reader over a memory mapped file, covering graph/digraph, strict,
+ * subgraphs, attribute statements and node/edge attributes.
+ * \return false when the file could not be read or uses syntax outside this subset (subgraphs as
+ * edge endpoints, HTML strings), callers fall back to DotFile in that case
+ */
+bool FastDotFile(const std::string& filename, DotGraph&);
+} // namespace Parser
+} // namespace DataVis
@@ -2,6 +2,7 @@
 
 namespace DataVis
 {
+// O(n^3) reference kernel, the layouts and metrics use ShortestPaths::AllPairs
 /**
  * \brief Calculates the Calculate graph-theoretic distance to be used for dimensionality reduction algorithms.
  * \param _dataset
@@ -71,7 +72,7 @@ inline void FloydWarshall(Dataset& _dataset, qdtsne::NeighborList<int, double>&
  * \param _dataset
  * \param _D MDS datastructure
  */
-void FloydWarshall(Dataset& _dataset, std::unique_ptr<smat::Matrix<double>>& _D)
+inline void FloydWarshall(Dataset& _dataset, std::unique_ptr<smat::Matrix<double>>& _D)
 {
 	const auto& vertices = _dataset.vertices;
 	auto& edges = _dataset.edges;
@@ -0,0 +1,138 @@
+#include "precomp.h"
+
+namespace DataVis
+{
+//--------------------------------------------------------------
+// KdTree
+//--------------------------------------------------------------
+void KdTree::Build(const std::vector<glm::vec2>& _points)
+{
+    m_points = _points;
+    m_order.resize(_points.size());
+    std::iota(m_order.begin(), m_order.end(), 0);
+    m_axis.assign(_points.size(), 0);
+    m_min.assign(_points.size(), glm::vec2(0));
+    m_max.assign(_points.size(), glm::vec2(0));
+    Build(0, static_cast<int>(_points.size()));
+}
+
+//--------------------------------------------------------------
+void KdTree::Build(int _begin, int _end)
+{
+    if (_end - _begin <= LEAF_SIZE) return;
+
+    // Split the widest side of the range
+    glm::vec2 min(MAX_FLOAT), max(-MAX_FLOAT);
+    for (int i = _begin; i < _end; i++)
+    {
+        min = glm::min(min, m_points[m_order[i]]);
+        max = glm::max(max, m_points[m_order[i]]);
+    }
+    const int axis = max.x - min.x >= max.y - min.y ? 0 : 1;
+    const int mid = (_begin + _end) / 2;
+    std::nth_element(m_order.begin() + _begin, m_order.begin() + mid, m_order.begin() + _end, [&](int _a, int _b)
+    {
+        return m_points[_a][axis] < m_points[_b][axis];
+    });
+    m_axis[mid] = static_cast<char>(axis);
+    m_min[mid] = min;
+    m_max[mid] = max;
+    Build(_begin, mid);
+    Build(mid + 1, _end);
+}
+
+//--------------------------------------------------------------
+void KdTree::Nearest(const glm::vec2& _p, int _self, int _k, std::vector<std::pair<float, int>>& _out) const
+{
+    // Max heap of the k closest so far, the pair order breaks ties by index
+    _out.clear();
+    if (_k <= 0) return;
+    Nearest(0, static_cast<int>(m_order.size()), _p, _self, _k, _out);
+    std::sort_heap(_out.begin(), _out.end());
+}
+
+//--------------------------------------------------------------
+void KdTree::Nearest(int _begin, int _end, const glm::vec2& _p, int _self, int _k, std::vector<std::pair<float, int>>& _heap) const
+{
+    auto visit = [&](int _point)
+    {
+        if (_point == _self) return;
+        const glm::vec2 d = m_points[_point] - _p;
+        const std::pair<float, int> candidate(d.x * d.x + d.y * d.y, _point);
+        if (_heap.size() < _k)
+        {
+            _heap.push_back(candidate);
+            std::push_heap(_heap.begin(), _heap.end());
+        }
+        else if (candidate < _heap.front())
+        {
+            std::pop_heap(_heap.begin(), _heap.end());
+            _heap.back() = candidate;
+            std::push_heap(_heap.begin(), _heap.end());
+        }
+    };
+
+    if (_end - _begin <= LEAF_SIZE)
+    {
+        for (int i = _begin; i < _end; i++)
+            visit(m_order[i]);
+        return;
+    }
+
+    // Near side first, the far side only when it can hold a closer point
+    const int mid = (_begin + _end) / 2;
+    const int axis = m_axis[mid];
+    const float diff = _p[axis] - m_points[m_order[mid]][axis];
+    visit(m_order[mid]);
+    if (diff < 0)
+    {
+        Nearest(_begin, mid, _p, _self, _k, _heap);
+        if (_heap.size() < _k || diff * diff <= _heap.front().first)
+            Nearest(mid + 1, _end, _p, _self, _k, _heap);
+    }
+    else
+    {
+        Nearest(mid + 1, _end, _p, _self, _k, _heap);
+        if (_heap.size() < _k || diff * diff <= _heap.front().first)
+            Nearest(_begin, mid, _p, _self, _k, _heap);
+    }
+}
+
+//--------------------------------------------------------------
+int KdTree::CountCloser(const glm::vec2& _p, int _self, const std::pair<float, int>& _key) const
+{
+    // The point itself is at distance 0, it is counted like any other point and taken out again
+    const int count = CountCloser(0, static_cast<int>(m_order.size()), _p, _key);
+    return count - (std::pair<float, int>(0.f, _self) < _key ? 1 : 0);
+}
+
+//--------------------------------------------------------------
+int KdTree::CountCloser(int _begin, int _end, const glm::vec2& _p, const std::pair<float, int>& _key) const
+{
+    auto closer = [&](int _point)
+    {
+        const glm::vec2 d = m_points[_point] - _p;
+        return std::pair<float, int>(d.x * d.x + d.y * d.y, _point) < _key ? 1 : 0;
+    };
+
+    if (_end - _begin <= LEAF_SIZE)
+    {
+        int count = 0;
+        for (int i = _begin; i < _end; i++)
+            count += closer(m_order[i]);
+        return count;
+    }
+
+    // Ranges entirely inside or outside the distance of the key need no visit, the bounds
+    // bound the distances of their points in floating point as well
+    const int mid = (_begin + _end) / 2;
+    const glm::vec2& min = m_min[mid];
+    const glm::vec2& max = m_max[mid];
+    const glm::vec2 far(std::max(std::abs(min.x - _p.x), std::abs(max.x - _p.x)), std::max(std::abs(min.y - _p.y), std::abs(max.y - _p.y)));
+    if (far.x * far.x + far.y * far.y < _key.first) return _end - _begin;
+    const glm::vec2 near(std::max(std::max(min.x - _p.x, _p.x - max.x), 0.f), std::max(std::max(min.y - _p.y, _p.y - max.y), 0.f));
+    if (near.x * near.x + near.y * near.y > _key.first) return 0;
+
+    return closer(m_order[mid]) + CountCloser(_begin, mid, _p, _key) + CountCloser(mid + 1, _end, _p, _key);
+}
+} // namespace DataVis
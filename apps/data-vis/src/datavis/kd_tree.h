@@ -0,0 +1,42 @@
+#pragma once
+
+namespace DataVis
+{
+//--------------------------------------------------------------
+// KdTree
+//--------------------------------------------------------------
+/**
+ * Static 2D kd-tree for k nearest neighbor queries. The tree is implicit, a permutation of the points
+ * where the median of every range splits it, so it is rebuilt from scratch with Build.
+ */
+class KdTree
+{
+public:
+    KdTree() = default;
+    void Build(const std::vector<glm::vec2>& points);
+
+    /**
+     * \brief The k points closest to p, as <squared distance, index> in increasing distance, ties in increasing index.
+     * \param self index of the point at p, it is skipped
+     */
+    void Nearest(const glm::vec2& p, int self, int k, std::vector<std::pair<float, int>>& out) const;
+
+    // Number of points before key in the order of Nearest, the rank of the point key refers to
+    [[nodiscard]] int CountCloser(const glm::vec2& p, int self, const std::pair<float, int>& key) const;
+
+private:
+    void Build(int begin, int end);
+    void Nearest(int begin, int end, const glm::vec2& p, int self, int k, std::vector<std::pair<float, int>>& heap) const;
+    [[nodiscard]] int CountCloser(int begin, int end, const glm::vec2& p, const std::pair<float, int>& key) const;
+
+    std::vector<glm::vec2> m_points;
+    // Indices of the points, the median of a range is at its middle
+    std::vector<int> m_order;
+    // Axis the middle of a range splits, 0 for x and 1 for y
+    std::vector<char> m_axis;
+    // Bounds of the range the middle splits
+    std::vector<glm::vec2> m_min, m_max;
+    // Ranges this small are searched linearly
+    static constexpr int LEAF_SIZE = 8;
+};
+} // namespace DataVis
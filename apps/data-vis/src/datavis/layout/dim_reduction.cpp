@@ -14,10 +14,14 @@ bool TSNELayout::Gui(IStructure& _structure)
 		ImGui::InputInt("Perplexity", &m_perplexity);
 		ImGui::InputInt("Scale", &m_scale);
 
-		if (ImGui::Button("Apply"))
+		if (job.Running())
+			job.Gui();
+		else if (ImGui::Button("Apply"))
 		{
-			Apply(_structure, m_iterations, m_perplexity, m_scale);
-			metrics->ComputeMetrics(_structure);
+			StartJob(_structure, [iterations = m_iterations, perplexity = m_perplexity, scale = m_scale](const Dataset& _dataset, LayoutJob::Progress& _progress)
+			{
+				return Compute(_dataset, iterations, perplexity, scale, _progress);
+			});
 			active = true;
 		}
 
@@ -29,26 +33,35 @@ bool TSNELayout::Gui(IStructure& _structure)
 
 void TSNELayout::Apply(IStructure& _structure, const int _iterations, const int _perplexity, const int _scale)
 {
-	qdtsne::NeighborList<int, double> D;
-	FloydWarshall(*_structure.dataset, D);
+	LayoutJob::Progress progress;
+	SetNewPositions(_structure, Compute(*_structure.dataset, _iterations, _perplexity, _scale, progress));
+}
+
+std::vector<glm::vec3> TSNELayout::Compute(const Dataset& _dataset, int _iterations, int _perplexity, int _scale, LayoutJob::Progress& _progress)
+{
+	const auto D = _dataset.GetDistanceCache().GetNeighbors(_dataset);
 
-	const int size = _structure.dataset->vertices.size();
+	const int size = _dataset.vertices.size();
 	// Run T-SNE
 	qdtsne::Tsne tsne;
 	tsne.set_max_iter(_iterations);
 	tsne.set_perplexity(_perplexity);
 	std::vector<double> Y = qdtsne::initialize_random(size, time(0)); // initial coordinates
-	tsne.run(D, Y.data());
-	
-	for (size_t i = 0; i < _structure.nodes.size(); i++)
+	auto status = tsne.initialize(*D);
+	// A few iterations at a time, so progress can be reported and the run cancelled
+	constexpr int step = 10;
+	for (int iteration = 0; iteration < _iterations;)
 	{
-		const auto& node = _structure.nodes[i];
-		glm::vec3 pos = glm::vec3(Y[i], Y[i + 1], 0);
-		pos *= _scale;
-		node->SetNewPosition(pos);
+		if (_progress.Cancelled()) return {};
+		iteration = std::min(iteration + step, _iterations);
+		status.run(Y.data(), iteration);
+		_progress.Set(static_cast<float>(iteration) / _iterations);
 	}
-	_structure.UpdateAABB();
-	_structure.UpdateEdges();
+
+	std::vector<glm::vec3> positions(size);
+	for (int i = 0; i < size; i++)
+		positions[i] = glm::vec3(Y[2 * i], Y[2 * i + 1], 0) * static_cast<float>(_scale);
+	return positions;
 }
 
 //--------------------------------------------------------------
@@ -62,10 +75,14 @@ bool MDSLayout::Gui(IStructure& _structure)
 		ImGui::InputInt("Iterations", &m_iterations);
 		ImGui::InputInt("Scale", &m_scale);
 
-		if (ImGui::Button("Apply"))
+		if (job.Running())
+			job.Gui();
+		else if (ImGui::Button("Apply"))
 		{
-			Apply(_structure, m_iterations, m_scale);
-			metrics->ComputeMetrics(_structure);
+			StartJob(_structure, [iterations = m_iterations, scale = m_scale](const Dataset& _dataset, LayoutJob::Progress& _progress)
+			{
+				return Compute(_dataset, iterations, scale, _progress);
+			});
 			active = true;
 		}
 
@@ -77,19 +94,59 @@ bool MDSLayout::Gui(IStructure& _structure)
 
 void MDSLayout::Apply(IStructure& _structure, const int _iterations, const int _scale)
 {
-	std::unique_ptr<smat::Matrix<double>> D;
-	FloydWarshall(*_structure.dataset, D);
+	LayoutJob::Progress progress;
+	SetNewPositions(_structure, Compute(*_structure.dataset, _iterations, _scale, progress));
+}
+
+std::vector<glm::vec3> MDSLayout::Compute(const Dataset& _dataset, int _iterations, int _scale, LayoutJob::Progress& _progress)
+{
+	const auto D = _dataset.GetDistanceCache().GetMatrix(_dataset);
+	const int size = _dataset.vertices.size();
+	if (size == 0 || _iterations < 1) return {};
 
-	// Run MDS
-	auto Y = smat::MDS_UCF(D.get(), nullptr, 2, _iterations);
-	for (size_t i = 0; i < _structure.nodes.size(); i++)
+	// Same stochastic descent as smat::MDS_UCF in two dimensions with r = 2. It is run here, so every iteration
+	// can report progress without restarting the library, which prints to stdout and reseeds the global rand()
+	constexpr double learning_rate = 0.05;
+	std::mt19937 rng(time(0));
+
+	// Random start around the origin, its spread scaled to the mean distance
+	double mean = 0;
+	for (int i = 0; i < size; i++)
 	{
-		auto& node = _structure.nodes[i];
-		glm::vec3 pos = glm::vec3(Y->get(i, 0), Y->get(i, 1), 0);
-		pos *= _scale;
-		node->SetNewPosition(pos);
+		for (int j = 0; j < size; j++)
+			mean += DistanceCache::Distance(*D, i, j);
 	}
-	_structure.UpdateAABB();
-	_structure.UpdateEdges();
+	mean /= static_cast<double>(size) * size;
+	const double spread = 0.1 * mean / (1. / 3. * std::sqrt(2.));
+	std::uniform_real_distribution<double> uniform(-0.5, 0.5);
+	std::vector<glm::dvec2> Y(size);
+	for (auto& y : Y)
+		y = glm::dvec2(uniform(rng), uniform(rng)) * spread;
+
+	// Every iteration moves all other points towards their target distance of a vertex, in a random vertex order
+	std::vector<int> order(size);
+	std::iota(order.begin(), order.end(), 0);
+	for (int iteration = 0; iteration < _iterations; iteration++)
+	{
+		if (_progress.Cancelled()) return {};
+		std::shuffle(order.begin(), order.end(), rng);
+		for (int m : order)
+		{
+			for (int i = 0; i < size; i++)
+			{
+				if (i == m) continue;
+				const glm::dvec2 delta = Y[m] - Y[i];
+				const double distance = glm::length(delta);
+				if (distance <= 0) continue;
+				Y[i] += delta * (learning_rate * (distance - DistanceCache::Distance(*D, i, m)) / distance);
+			}
+		}
+		_progress.Set(static_cast<float>(iteration + 1) / _iterations);
+	}
+
+	std::vector<glm::vec3> positions(size);
+	for (int i = 0; i < size; i++)
+		positions[i] = glm::vec3(Y[i], 0) * static_cast<float>(_scale);
+	return positions;
 }
 }
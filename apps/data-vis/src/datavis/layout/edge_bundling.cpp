@@ -16,27 +16,89 @@ bool EdgeBundlingLayout::Gui(IStructure& _structure)
 		ImGui::Checkbox("Quadratic?", &m_quadratic);
 		ImGui::Checkbox("Check Owners?", &m_check_owners);
 
-		if (ImGui::Button("Apply"))
+		if (job.Running())
+			job.Gui();
+		else if (ImGui::Button("Apply"))
 		{
-			try
+			// Clusters lay out their sub-graphs first. That runs in the job too, on copies of the positions
+			struct SubGraph
 			{
-				auto& clusters = dynamic_cast<Clusters&>(_structure);
-				for (auto& graph : clusters.sub_graphs)
+				std::shared_ptr<Dataset> dataset;
+				std::vector<glm::vec3> positions;
+				glm::vec3 offset, top_left, bottom_right;
+			};
+			std::vector<SubGraph> sub_graphs;
+			if (auto* clusters = dynamic_cast<Clusters*>(&_structure))
+			{
+				for (auto& graph : clusters->sub_graphs)
 				{
-					ForceDirectedLayout::Apply(*graph, 0.5f, 0.002f, 500);
-					graph->UpdateEdges(true);
+					auto& sub_graph = sub_graphs.emplace_back();
+					sub_graph.dataset = graph->dataset;
+					sub_graph.offset = graph->GetPosition();
+					sub_graph.top_left = graph->GetAABB().GetTopLeft();
+					sub_graph.bottom_right = graph->GetAABB().GetBottomRight();
+					for (const auto& node : graph->nodes)
+						sub_graph.positions.push_back(node->GetPosition());
 				}
-				_structure.UpdateEdges(true);
-			}
-			catch (std::exception& e)
-			{
-				std::cout << e.what() << std::endl;
 			}
 
-			Apply(_structure, m_C, m_l, m_K, m_n, m_s, m_comp_threshold, m_quadratic, m_check_owners, Compatibility);
+			// Bundle copies of the edge paths, the structure keeps drawing the old ones until the commit
+			VectorOfEdgePaths paths;
+			paths.reserve(_structure.edges.size());
 			for (const auto& edge : _structure.edges)
-				edge->ForceUpdate();
-			metrics->ComputeMetrics( _structure );
+				paths.push_back(std::make_shared<EdgePath>(*edge));
+
+			job.Start([&_structure, dataset = _structure.dataset, paths = std::move(paths), sub_graphs = std::move(sub_graphs), C = m_C, l = m_l, K = m_K,
+				n = m_n, s = m_s, threshold = m_comp_threshold, quadratic = m_quadratic, check_owners = m_check_owners,
+				metrics = metrics](LayoutJob::Progress& _progress) mutable -> LayoutJob::Commit
+			{
+				if (!sub_graphs.empty())
+				{
+					std::unordered_map<std::string, int> graph_idx;
+					for (int g = 0; g < sub_graphs.size(); g++)
+					{
+						if (_progress.Cancelled()) return nullptr;
+						auto& sub_graph = sub_graphs[g];
+						graph_idx[sub_graph.dataset->GetId()] = g;
+						ForceDirectedLayout::Compute(*sub_graph.dataset, sub_graph.positions, sub_graph.top_left, sub_graph.bottom_right, 0.5f, 0.002f, 500);
+					}
+					// The inter edges are bundled between the new positions
+					for (auto& path : paths)
+					{
+						const auto& edge = dataset->edges[path->GetEdgeIdx()];
+						const auto& from = *dataset->vertices[edge.from_idx];
+						const auto& to = *dataset->vertices[edge.to_idx];
+						const auto& from_graph = sub_graphs[graph_idx.at(from.owner)];
+						const auto& to_graph = sub_graphs[graph_idx.at(to.owner)];
+						path->UpdateStartPoint(from_graph.positions[from.idx] + from_graph.offset);
+						path->UpdateEndPoint(to_graph.positions[to.idx] + to_graph.offset);
+						path->ForceUpdate();
+					}
+				}
+
+				if (!Compute(*dataset, paths, C, l, K, n, s, threshold, quadratic, check_owners, Compatibility, _progress))
+					return nullptr;
+				return [&_structure, dataset, paths, sub_graphs = std::move(sub_graphs), metrics]()
+				{
+					if (_structure.dataset != dataset || _structure.edges.size() != paths.size()) return;
+					if (auto* clusters = dynamic_cast<Clusters*>(&_structure); clusters && clusters->sub_graphs.size() == sub_graphs.size())
+					{
+						for (size_t g = 0; g < sub_graphs.size(); g++)
+						{
+							auto& nodes = clusters->sub_graphs[g]->nodes;
+							if (nodes.size() != sub_graphs[g].positions.size()) continue;
+							for (size_t i = 0; i < nodes.size(); i++)
+								nodes[i]->SetNewPosition(sub_graphs[g].positions[i]);
+						}
+					}
+					for (size_t i = 0; i < paths.size(); i++)
+					{
+						_structure.edges[i]->points = paths[i]->points;
+						_structure.edges[i]->ForceUpdate();
+					}
+					metrics->ComputeMetrics( _structure );
+				};
+			});
 			active = true;
 		}
 
@@ -48,13 +110,26 @@ bool EdgeBundlingLayout::Gui(IStructure& _structure)
 
 void EdgeBundlingLayout::Apply(IStructure& _structure, int _C, int _l, float _K, int _n, float _s, float _threshold, bool _quadratic, bool _check_owners, CompatibilityFunction _f)
 {
-	const auto& vertices = _structure.dataset->vertices;
-	const auto& edges = _structure.dataset->edges;
+	LayoutJob::Progress progress;
+	Compute(*_structure.dataset, _structure.edges, _C, _l, _K, _n, _s, _threshold, _quadratic, _check_owners, _f, progress);
+	for (const auto& edge : _structure.edges)
+		edge->ForceUpdate();
+}
+
+bool EdgeBundlingLayout::Compute(const Dataset& _dataset, const VectorOfEdgePaths& _paths, int _C, int _l, float _K, int _n, float _s, float _threshold, bool _quadratic, bool _check_owners, CompatibilityFunction _f, LayoutJob::Progress& _progress)
+{
+	const auto& vertices = _dataset.vertices;
+	const auto& edges = _dataset.edges;
+
+	// Iterations over all cycles, for the progress
+	int total = 0, done = 0;
+	for (int c = 0, l = _l; c < _C; c++, l = l * 2 / 3)
+		total += l;
 
 	std::unordered_map<EdgeIdx, std::unordered_map<EdgeIdx, float>> edge_compatibility;
-	for(const auto& p : _structure.edges)
+	for(const auto& p : _paths)
 	{
-		for(const auto& q : _structure.edges)
+		for(const auto& q : _paths)
 		{
 			if(p->GetEdgeIdx() == q->GetEdgeIdx()) continue;
 			if(_check_owners)
@@ -76,14 +151,15 @@ void EdgeBundlingLayout::Apply(IStructure& _structure, int _C, int _l, float _K,
 	// For c cycles
 	for (int c = 0; c < _C; c++)
 	{
-		for (auto& edge : _structure.edges)
+		for (auto& edge : _paths)
 			edge->Subdivide(_n);
 
 		// For l iterations calculate forces
 		for (int l = 0; l < _l; l++)
 		{
-			std::cout << "Cycle: " << c << ", Iteration: " << l << std::endl;
-			for (auto& p : _structure.edges)
+			if (_progress.Cancelled()) return false;
+			_progress.Set(static_cast<float>(done++) / static_cast<float>(std::max(total, 1)));
+			for (auto& p : _paths)
 			{
 				const glm::vec3 edge = p->points.back().value - p->points.front().value;
 				const float k_p = (_K / glm::length(edge)) * (p->points.size() - 1);
@@ -99,7 +175,7 @@ void EdgeBundlingLayout::Apply(IStructure& _structure, int _C, int _l, float _K,
 					//
 					glm::vec3 sum_force = k_p * (k_prev.value + k_next.value);
 
-					for (auto& q : _structure.edges)
+					for (auto& q : _paths)
 					{
 						// if (q->GetEdgeIdx() == p->GetEdgeIdx()) continue;
 						//
@@ -144,7 +220,7 @@ void EdgeBundlingLayout::Apply(IStructure& _structure, int _C, int _l, float _K,
 		}
 
 		// Apply calculated forces
-		for (auto& p : _structure.edges)
+		for (auto& p : _paths)
 		{
 			for (int i = 1; i < p->points.size() - 1; i++)
 			{
@@ -157,6 +233,8 @@ void EdgeBundlingLayout::Apply(IStructure& _structure, int _C, int _l, float _K,
 		_s *= .5f;
 		_l = _l * 2 / 3;
 	}
+	_progress.Set(1.f);
+	return true;
 }
 
 //--------------------------------------------------------------
@@ -2,6 +2,33 @@
 
 namespace DataVis
 {
+//--------------------------------------------------------------
+// Layout
+//--------------------------------------------------------------
+void ILayout::SetNewPositions(IStructure& _structure, const std::vector<glm::vec3>& _positions)
+{
+	for (size_t i = 0; i < _structure.nodes.size(); i++)
+		_structure.nodes[i]->SetNewPosition(_positions[i]);
+	_structure.UpdateAABB();
+	_structure.UpdateEdges();
+}
+
+void ILayout::StartJob(IStructure& _structure, std::function<std::vector<glm::vec3>(const Dataset&, LayoutJob::Progress&)> _compute)
+{
+	job.Start([&_structure, dataset = _structure.dataset, compute = std::move(_compute), metrics = metrics](LayoutJob::Progress& _progress) -> LayoutJob::Commit
+	{
+		auto positions = compute(*dataset, _progress);
+		if (positions.empty()) return nullptr;
+		return [&_structure, dataset, positions = std::move(positions), metrics]()
+		{
+			// Another layout may have replaced the dataset in the meantime
+			if (_structure.dataset != dataset || _structure.nodes.size() != positions.size()) return;
+			SetNewPositions(_structure, positions);
+			metrics->ComputeMetrics(_structure);
+		};
+	});
+}
+
 //--------------------------------------------------------------
 // Random
 //--------------------------------------------------------------
@@ -141,31 +168,37 @@ void RadialLayout::Draw()
 //--------------------------------------------------------------
 void RadialLayout::Apply(ITree& _tree, float _start, float _step)
 {
-	const auto& node = _tree.Root();
-	node->SetNewPosition(glm::vec3(0));
-	SubTree(*node, 0, TWO_PI, 0, _start, _step);
+	// Wedge and level of every vertex, the depth first order places a parent before its children
+	const size_t size = _tree.nodes.size();
+	std::vector<float> wedge_start(size), wedge_end(size);
+	std::vector<int> level(size);
+	const VertexIdx root = _tree.Root();
+	wedge_start[root] = 0;
+	wedge_end[root] = TWO_PI;
+	level[root] = 0;
+	_tree.nodes[root]->SetNewPosition(glm::vec3(0));
+	for (const VertexIdx v : _tree.Order())
+	{
+		float new_wedge_start = wedge_start[v];
+		const float radius = _start + (_step * level[v]);
+		const uint parent_leaves = _tree.Leaves(v);
+		for (VertexIdx child = _tree.FirstChild(v); child != ITree::NONE; child = _tree.NextSibling(child))
+		{
+			const uint child_leaves = _tree.Leaves(child);
+			const float new_wedge_end = new_wedge_start +
+				static_cast<float>(child_leaves) / static_cast<float>(parent_leaves) *
+					(wedge_end[v] - wedge_start[v]);
+			const float angle = (new_wedge_start + new_wedge_end) * .5f;
+			_tree.nodes[child]->SetNewPosition(glm::vec3(radius * glm::cos(angle), radius * glm::sin(angle), 0));
+			wedge_start[child] = new_wedge_start;
+			wedge_end[child] = new_wedge_end;
+			level[child] = level[v] + 1;
+			new_wedge_start = new_wedge_end;
+		}
+	}
 	_tree.UpdateAABB();
 	_tree.UpdateEdges();
 }
-
-//--------------------------------------------------------------
-void RadialLayout::SubTree(ITree::TreeNode& _node, float _wedge_start, float _wedge_end, int _depth, float _start, float _step)
-{
-	float new_wedge_start = _wedge_start;
-	const float radius = _start + (_step * _depth);
-	const uint parent_leaves = ITree::Leaves(std::make_shared<ITree::TreeNode>(_node));
-	for (auto& child : _node.children) {
-		const uint child_leaves = ITree::Leaves(child);
-		const float new_wedge_end = new_wedge_start +
-			static_cast<float>(child_leaves) / static_cast<float>(parent_leaves) *
-				(_wedge_end - _wedge_start);
-		const float angle = (new_wedge_start + new_wedge_end) * .5f;
-		child->SetNewPosition(glm::vec3(radius * glm::cos(angle), radius * glm::sin(angle), 0));
-		if (!child->children.empty())
-			SubTree(*child, new_wedge_start, new_wedge_end, _depth + 1, _start, _step);
-		new_wedge_start = new_wedge_end;
-	}
-}
 #pragma endregion // Radial
 
 //--------------------------------------------------------------
@@ -180,6 +213,10 @@ bool ForceDirectedLayout::Gui(IStructure& _structure)
 		ImGui::InputFloat("C", &m_C);
 		ImGui::InputFloat("T", &m_T);
 		ImGui::InputInt("Iterations/Frame", &m_iterations);
+		ImGui::Checkbox("Barnes-Hut", &m_barnes_hut);
+		if (m_barnes_hut)
+			ImGui::SliderFloat("Theta", &m_theta, 0.f, 2.f);
+		ImGui::SliderInt("Threads", &m_threads, 0, ThreadPool::Global().Size(), m_threads == 0 ? "All" : "%d");
 
 		if (ImGui::Checkbox( "Enabled", &m_enabled ))
 		{
@@ -187,7 +224,7 @@ bool ForceDirectedLayout::Gui(IStructure& _structure)
 		}
 
 		if (m_enabled) {
-			Apply(_structure, m_C, m_T, m_iterations);
+			Apply(_structure, m_C, m_T, m_iterations, m_barnes_hut, m_theta, m_threads);
 			_structure.UpdateEdges(true);
 			active = true;
 		}
@@ -205,50 +242,139 @@ bool ForceDirectedLayout::Gui(IStructure& _structure)
 }
 
 //--------------------------------------------------------------
-void ForceDirectedLayout::Apply(IStructure& _structure, float _C, float _t, int _iterations)
+namespace
+{
+	// Cheap per element work is handed out in blocks, so it does not pay the scheduling cost per index
+	void ParallelBlocks(int _size, uint _threads, const std::function<void(int, int)>& _f)
+	{
+		constexpr int block = 256;
+		ThreadPool::Global().ParallelFor(0, (_size + block - 1) / block, [&](int b)
+		{
+			_f(b * block, std::min(_size, (b + 1) * block));
+		}, _threads);
+	}
+}
+
+void ForceDirectedLayout::Apply(IStructure& _structure, float _C, float _t, int _iterations, bool _barnes_hut, float _theta, uint _threads)
 {
-	const float area = _structure.GetArea();
-	const float k = _C * sqrtf(area / _structure.nodes.size());
+	std::vector<glm::vec3> positions(_structure.nodes.size());
+	for (size_t i = 0; i < positions.size(); i++)
+		positions[i] = _structure.nodes[i]->GetPosition();
+	const AABB& aabb = _structure.GetAABB();
+	Compute(*_structure.dataset, positions, aabb.GetTopLeft(), aabb.GetBottomRight(), _C, _t, _iterations, _barnes_hut, _theta, _threads);
+	for (size_t i = 0; i < positions.size(); i++)
+		_structure.nodes[i]->SetPosition(positions[i]);
+}
+
+void ForceDirectedLayout::Compute(const Dataset& _dataset, std::vector<glm::vec3>& _positions, const glm::vec3& _top_left, const glm::vec3& _bottom_right,
+                                  float _C, float _t, int _iterations, bool _barnes_hut, float _theta, uint _threads)
+{
+	const int size = _positions.size();
+	const float area = (_bottom_right.x - _top_left.x) * (_bottom_right.y - _top_left.y);
+	const float k = _C * sqrtf(area / size);
 	const float k2 = k * k;
+	const glm::vec3 top_left = _top_left;
+	const glm::vec3 bottom_right = _bottom_right;
+
+	// Flat copies of the positions, they are only written again after the last iteration
+	std::vector<float> x(size), y(size), dx(size), dy(size);
+	for (int i = 0; i < size; i++)
+	{
+		x[i] = _positions[i].x;
+		y[i] = _positions[i].y;
+	}
+
+	// Incident edges per vertex in edge order, 2 * edge for the source and 2 * edge + 1 for the target.
+	// Every vertex sums its attraction in the same order as a serial loop over the edges would.
+	const auto& edges = _dataset.edges;
+	std::vector<int> offsets(size + 1, 0);
+	for (const auto& e : edges)
+	{
+		offsets[e.from_idx + 1]++;
+		offsets[e.to_idx + 1]++;
+	}
+	for (int i = 0; i < size; i++)
+		offsets[i + 1] += offsets[i];
+	std::vector<int> incident(offsets.back());
+	std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+	for (int e = 0; e < edges.size(); e++)
+	{
+		incident[fill[edges[e].from_idx]++] = 2 * e;
+		incident[fill[edges[e].to_idx]++] = 2 * e + 1;
+	}
+	std::vector<float> offset_x(edges.size()), offset_y(edges.size());
 
+	QuadTree tree;
+	std::vector<glm::vec2> positions;
 	for (int i = 0; i < _iterations; i++)
 	{
-		// Repulsion
-		for (const auto& v : _structure.nodes)
+		// Repulsion, every vertex only writes its own displacement
+		if (_barnes_hut)
 		{
-			v->SetDisplacement(glm::vec3(0));
-			for (const auto& u : _structure.nodes)
+			// Rebuild the tree every iteration, O(n log n) instead of O(n^2)
+			positions.resize(size);
+			for (int v = 0; v < size; v++)
+				positions[v] = glm::vec2(x[v], y[v]);
+			tree.Build(positions);
+		}
+		ThreadPool::Global().ParallelFor(0, size, [&](int v)
+		{
+			if (_barnes_hut)
 			{
-				if (v->GetVertexIdx() == u->GetVertexIdx()) continue;
-
-				glm::vec3 delta = v->GetPosition() - u->GetPosition();
-				const float delta_l = length(delta);
+				const glm::vec2 repulsion = tree.Repulsion(positions[v], v, k2, _theta);
+				dx[v] = repulsion.x;
+				dy[v] = repulsion.y;
+				return;
+			}
+			float sum_x = 0, sum_y = 0;
+			for (int u = 0; u < size; u++)
+			{
+				if (v == u) continue;
+				const float delta_x = x[v] - x[u];
+				const float delta_y = y[v] - y[u];
+				const float delta_l = sqrtf(delta_x * delta_x + delta_y * delta_y);
 				const float fr = k2 / delta_l;
-				v->SetDisplacement(v->GetDisplacement() + (delta / delta_l) * fr);
+				sum_x += (delta_x / delta_l) * fr;
+				sum_y += (delta_y / delta_l) * fr;
 			}
-		}
+			dx[v] = sum_x;
+			dy[v] = sum_y;
+		}, _threads);
 
-		// Attraction
-		for (const auto& e : _structure.dataset->edges)
+		// Attraction, computed once per edge and gathered per vertex
+		ParallelBlocks(edges.size(), _threads, [&](int _begin, int _end)
 		{
-			const auto& v = _structure.nodes[e.from_idx];
-			const auto& u = _structure.nodes[e.to_idx];
-			glm::vec3 delta = v->GetPosition() - u->GetPosition();
-			const float delta_l = length(delta);
-			glm::vec3 offset = (delta / delta_l) * (delta_l * delta_l / k);
-			v->SetDisplacement(v->GetDisplacement() - offset);
-			u->SetDisplacement(u->GetDisplacement() + offset);
-		}
+			for (int e = _begin; e < _end; e++)
+			{
+				const float delta_x = x[edges[e].from_idx] - x[edges[e].to_idx];
+				const float delta_y = y[edges[e].from_idx] - y[edges[e].to_idx];
+				const float delta_l = sqrtf(delta_x * delta_x + delta_y * delta_y);
+				const float fa = delta_l * delta_l / k;
+				offset_x[e] = (delta_x / delta_l) * fa;
+				offset_y[e] = (delta_y / delta_l) * fa;
+			}
+		});
 
-		for (const auto& node : _structure.nodes)
+		ParallelBlocks(size, _threads, [&](int _begin, int _end)
 		{
-			glm::vec3 new_pos = node->GetPosition() + node->GetDisplacement() * _t;
-			new_pos = _structure.GetAABB().Clamp(new_pos);
-			node->SetPosition(new_pos);
-			node->SetDisplacement(glm::vec3(0));
-		}
+			for (int v = _begin; v < _end; v++)
+			{
+				for (int j = offsets[v]; j < offsets[v + 1]; j++)
+				{
+					const int e = incident[j] / 2;
+					const float sign = incident[j] % 2 == 0 ? -1.f : 1.f;
+					dx[v] += sign * offset_x[e];
+					dy[v] += sign * offset_y[e];
+				}
+				x[v] = std::min(std::max(x[v] + dx[v] * _t, top_left.x), bottom_right.x);
+				y[v] = std::min(std::max(y[v] + dy[v] * _t, top_left.y), bottom_right.y);
+			}
+		});
 		_t *= 0.9999f;
 	}
+
+	for (int i = 0; i < size; i++)
+		_positions[i] = glm::clamp(glm::vec3(x[i], y[i], _positions[i].z), top_left, bottom_right);
 }
 #pragma endregion // Force Directed
 } // namespace DataVis
\ No newline at end of file
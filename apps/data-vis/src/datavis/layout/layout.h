@@ -20,8 +20,16 @@ public:
     }
 
     std::shared_ptr<IQualityMetrics> metrics;
+    // Apply running in the background, IStructure::Update commits its result
+    LayoutJob job;
     
     virtual ~ILayout() = default;
+
+protected:
+    // Animates the nodes to the positions, indexed like IStructure::nodes
+    static void SetNewPositions(IStructure&, const std::vector<glm::vec3>& positions);
+    // Runs compute on the job, then sets the positions it returns and computes the metrics
+    void StartJob(IStructure&, std::function<std::vector<glm::vec3>(const Dataset&, LayoutJob::Progress&)> compute);
 };
 
 //--------------------------------------------------------------
@@ -66,7 +74,8 @@ public:
 private:
     static float CalculateCost(const IStructure& _structure);
     static float CalculateIncrementalCost(const IStructure& _structure, uint _idx0, uint _idx1);
-    static float CalculateNodeCost(const IStructure& _structure, uint _idx);
+    // Cost of the edges of a node at a position, with the other node of the swap at its own position
+    static float CalculateNodeCost(const IStructure& _structure, uint _idx, const glm::vec3& _position, uint _other_idx, const glm::vec3& _other_position);
     static void SwapPos(IStructure& _structure, float& _currCost);
     int m_iterations = 10000;
 };
@@ -81,11 +90,10 @@ public:
     bool Gui(IStructure&) override;
     void Update(float) override;
     void Draw() override;
+    // Pavlo, 2006 https://scholarworks.rit.edu/cgi/viewcontent.cgi?referer=&httpsredir=1&article=1355&context=theses
     static void Apply(ITree&, float start, float step);
 
 private:
-    // Pavlo, 2006 https://scholarworks.rit.edu/cgi/viewcontent.cgi?referer=&httpsredir=1&article=1355&context=theses
-    static void SubTree(ITree::TreeNode&, float angle_start, float angle_end, int depth, float step, float delta_angle);
     float m_start = 100, m_step = 100;
     Rings m_rings;
 };
@@ -98,13 +106,21 @@ class ForceDirectedLayout final : public ILayout
 public:
     ForceDirectedLayout() { metrics = std::make_shared<GraphQualityMetrics>(); };
     bool Gui(IStructure&) override;
-    static void Apply(IStructure&, float _C, float _t, int _iterations);
+    // With _barnes_hut the repulsion is approximated with a quadtree, _theta trades accuracy for speed.
+    // The kernel is spread over _threads threads of the global pool, 0 uses all of them; the result does not depend on it
+    static void Apply(IStructure&, float _C, float _t, int _iterations, bool _barnes_hut = false, float _theta = .5f, uint _threads = 0);
+    // The same iterations on a copy of the positions per vertex, kept inside [top_left, bottom_right]
+    static void Compute(const Dataset&, std::vector<glm::vec3>& positions, const glm::vec3& top_left, const glm::vec3& bottom_right,
+                        float _C, float _t, int _iterations, bool _barnes_hut = false, float _theta = .5f, uint _threads = 0);
 
 private:
     float m_C = 0.5, m_T = 0.002;
     int m_iterations = 10;
     bool m_enabled = false;
     bool m_compute_metrics = false;
+    bool m_barnes_hut = false;
+    float m_theta = .5f;
+    int m_threads = 0;
 };
 
 //--------------------------------------------------------------
@@ -114,97 +130,176 @@ class SugiyamaLayout final : public ILayout
 {
 public:
     using Layer = std::vector<int>;
-    using GetNeighbors = std::function<std::vector<Neighbor>(Vertex&)>;
-    using OSCMHeuristic = std::function<bool(const Dataset&, const Layer&, Layer&, Layer&, const GetNeighbors)>;
+    using GetNeighbors = std::function<Adjacency::Neighbors(VertexIdx)>;
+    using OSCMHeuristic = std::function<bool(const Layer&, Layer&, Layer&, const GetNeighbors)>;
+
+    enum class Layering
+    {
+        // Every vertex on the layer below its lowest predecessor, fast but the edges get long
+        LongestPath,
+        // Least total edge span, so the least dummy vertices
+        NetworkSimplex
+    };
+
+    /**
+     * Compact graph the steps of the framework work on instead of copies of the dataset.
+     * The dummy vertices of the long edges are numbered after the vertices of the dataset,
+     * the edges they split the long edges into are appended after the edges of the dataset.
+     */
+    struct LayeredGraph
+    {
+        int dataset_vertex_count = 0;
+        // Including the dummy vertices
+        int vertex_count = 0;
+        std::vector<VertexIdx> from, to;
+        // Edge of the dataset every edge is part of
+        std::vector<EdgeIdx> owner;
+        // Per edge of the dataset, true when BreakCycles turned it around
+        std::vector<bool> reversed;
+        // Rebuilt by the steps that change the edges
+        Adjacency adjacency;
+
+        void Init(const Dataset&);
+        void BuildAdjacency();
+        [[nodiscard]] bool IsDummy(VertexIdx v) const { return v >= dataset_vertex_count; }
+    };
+
+    // What the layering cost the steps after it
+    struct Statistics
+    {
+        int dummy_vertices = 0;
+        float layering_ms = 0;
+        // False when the network simplex hit its pivot limit before the total edge span was minimal
+        bool layering_optimal = true;
+        // Crossing minimization and vertex positioning, they grow with the dummy vertices
+        float downstream_ms = 0;
+    };
+
+    // Everything Compute produces from the dataset, Commit writes it into the graph
+    struct Result
+    {
+        // The vertices of the dataset first, then the dummy vertices of the long edges, empty when cancelled
+        std::vector<glm::vec3> positions;
+        // Edges of the input dataset, the edge paths are indexed by them
+        size_t edge_count = 0;
+        // Per edge of the input dataset [before, source, dummies..., target, after] in [path_offsets[e], path_offsets[e + 1]).
+        // The vertices before and after bend the curved edges, -1 when there is none
+        std::vector<int> path_offsets;
+        std::vector<VertexIdx> path_vertices;
+        Statistics statistics;
+        int crossings = 0;
+        // Seed of the restart with the least crossings, one iteration with it gives the same layers
+        uint winning_seed = 0;
+    };
 
     SugiyamaLayout();
     bool Gui(IStructure&) override;
     static void Apply(Graph&, const OSCMHeuristic& oscm_heuristic, const glm::vec2& node_offset,
-                      const int& oscm_iterations, bool _curved_edges = true);
-
-private:
-    std::vector<std::pair<std::string, OSCMHeuristic>> m_oscm_heuristics;
-    OSCMHeuristic m_oscm_heuristic;
-    int m_oscm_heuristic_idx = 0;
-    int m_oscm_iterations = 100;
-    glm::vec2 m_node_offset;
-    bool m_curved_edges = false;
-
-    // Sugiyama Framework
-    static Dataset BreakCycles(Dataset&, std::vector<int>& reversed_edges);
-    static void LayerAssignment(const Dataset&, std::vector<Layer>& vertices_per_layer, Layer& layer_per_vertex);
-    static void AddDummyVertices(Dataset&, std::vector<Layer>& vertices_per_layer, Layer& layer_per_vertex);
-    static int CrossingMinimization(Dataset&, std::vector<Layer>& vertices_per_layer, const OSCMHeuristic& heuristic,
-                                    int iterations);
-    
+                      const int& oscm_iterations, bool _curved_edges = true, Layering = Layering::LongestPath,
+                      uint oscm_seed = 0, bool parallel_oscm = false);
+    static Result Compute(const Dataset&, const OSCMHeuristic& oscm_heuristic, Layering, const glm::vec2& node_offset,
+                          int oscm_iterations, uint oscm_seed, bool parallel_oscm, LayoutJob::Progress&);
+    static void Commit(Graph&, const Result&, const glm::vec2& node_offset, bool curved_edges);
+
+    // Sugiyama Framework, the steps are public so the benchmarks can run them on their own
+    static void BreakCycles(LayeredGraph&);
+    static void LayerAssignment(const LayeredGraph&, std::vector<Layer>& vertices_per_layer, Layer& layer_per_vertex);
+    // Starts from LayerAssignment, then moves the vertices until the total edge span is minimal.
+    // Returns false when the pivot limit stopped it first, the layering is then feasible but not optimal
+    static bool NetworkSimplexLayering(const LayeredGraph&, std::vector<Layer>& vertices_per_layer, Layer& layer_per_vertex);
+    static void AddDummyVertices(LayeredGraph&, std::vector<Layer>& vertices_per_layer, Layer& layer_per_vertex);
+    /**
+     * \brief Restarts the sweeps from shuffled layers and keeps the layers with the least crossings.
+     * Restart i shuffles with its own generator seeded with seed + i, ties go to the lowest restart,
+     * so the parallel restarts give the same layers as the sequential ones.
+     * \param winning_seed the seed of the restart that was kept
+     */
+    static int CrossingMinimization(const LayeredGraph&, std::vector<Layer>& vertices_per_layer, const OSCMHeuristic& heuristic,
+                                    int iterations, LayoutJob::Progress&, uint seed = 0, bool parallel = false,
+                                    uint* winning_seed = nullptr);
     static std::vector<float> VertexPositioning(
-        const Dataset& dataset,
+        const LayeredGraph& graph,
         const std::vector<Layer>& vertices_per_layer,
-        Layer& layer_per_vertex,
         float delta_x);
-
-    //--------------------------------------------------------------
-    // Layer Assignment
-    //--------------------------------------------------------------
-    static bool IsSink(const Vertex&);
-    static bool IsSource(const Vertex&);
-    static bool HasUnvisited(const std::function<bool(Vertex&)>&, std::vector<std::shared_ptr<Vertex>>, Vertex& out);
-    static void RemoveOutgoingNeighbors(Dataset&, Vertex&);
-    static void RemoveIncomingNeighbors(const Dataset&, Vertex&);
-    static void RemoveNeighbors(Dataset&, const Edge&);
-    static void AddNeighbors(const Dataset&, Edge&);
+    // Crossings between the edges from layer_1 to layer_2, O(E log V) with an accumulator tree
+    static int Crossings(const Adjacency&, const Layer& layer_1, const Layer& layer_2);
 
     //--------------------------------------------------------------
     // OSCM
     //--------------------------------------------------------------
     static bool OSCMBarycenterHeuristic(
-        const Dataset& dataset,
         const Layer& layer_fixed,
         Layer& layer,
         Layer& new_layer,
         const GetNeighbors& get_neighbors);
     
     static bool OSCMMedianHeuristic(
-        const Dataset& dataset,
         const Layer& layer_fixed,
         Layer& layer,
         Layer& new_layer,
         const GetNeighbors& get_neighbors);
 
-    static int Crossings(const Dataset&, const Layer& layer_1, const Layer& layer_2);
+private:
+    // Runs the layout as a job with the other settings of the GUI, returns whether it started
+    bool Start(IStructure&, int oscm_iterations, uint oscm_seed, bool compare_layerings);
+
+    std::vector<std::pair<std::string, OSCMHeuristic>> m_oscm_heuristics;
+    OSCMHeuristic m_oscm_heuristic;
+    int m_oscm_heuristic_idx = 0;
+    int m_oscm_iterations = 100;
+    int m_oscm_seed = 0;
+    bool m_parallel_oscm = true;
+    std::optional<uint> m_winning_seed;
+    int m_crossings = 0;
+    glm::vec2 m_node_offset;
+    bool m_curved_edges = false;
+    Layering m_layering = Layering::LongestPath;
+    // Also runs the other layering on the same dataset, for its statistics
+    bool m_compare_layerings = false;
+    // Of the last run per layering
+    std::optional<Statistics> m_statistics[2];
 
     //--------------------------------------------------------------
     // Node Positioning
     //--------------------------------------------------------------
-    static void FlagType1Conflicts(
-        const Dataset&,
-        const std::vector<Layer>& vertices_per_layer,
-        Layer& layer_per_vertex,
-        std::vector<std::pair<int, int>>& flags);
-
+    // The layers flattened, layer i is [layer_offsets[i], layer_offsets[i + 1]) of layer_vertices
+    struct FlatLayers
+    {
+        std::vector<int> layer_offsets;
+        std::vector<VertexIdx> layer_vertices;
+        std::vector<int> layer_per_vertex;
+        std::vector<int> pos_per_vertex;
+        // Per vertex its neighbors on the layer above [0] and below [1], sorted on their position
+        std::vector<int> neighbor_offsets[2];
+        std::vector<Neighbor> neighbors[2];
+
+        void Init(const LayeredGraph&, const std::vector<Layer>& vertices_per_layer);
+        [[nodiscard]] int LayerSize(int layer) const { return layer_offsets[layer + 1] - layer_offsets[layer]; }
+    };
+
+    // Marks the edges that cross an edge between two dummy vertices, the alignments leave them out
+    static void FlagType1Conflicts(const LayeredGraph&, const FlatLayers&, std::vector<bool>& conflicted_edges);
+
+    // Aligns every vertex with a median neighbor on the layer before it, sweeping the layers
+    // downwards or upwards and every layer from the left or the right
     static void VerticalAlignment(
-        const Dataset&,
-        const std::vector<Layer>& vertices_per_layer,
-        Layer& layer_per_vertex,
-        const Layer& pos_per_vertex,
-        std::vector<int>& root,
-        std::vector<int>& align,
-        std::vector<std::pair<int, int>>& flags);
+        const FlatLayers&,
+        const std::vector<bool>& conflicted_edges,
+        bool downwards,
+        bool from_left,
+        std::vector<int>& root);
 
+    // Places the blocks of the alignment as close as the delta between neighbors allows, from the left or the right
     static void HorizontalCompaction(
-        const Dataset&,
-        const std::vector<Layer>& vertices_per_layer,
-        const Layer& layer_per_vertex,
-        const Layer& pos_per_vertex,
+        const FlatLayers&,
         const std::vector<int>& root,
-        const std::vector<int>& align,
-        std::vector<float>& x_per_vertex,
-        float delta);
+        bool from_left,
+        float delta,
+        std::vector<float>& x_per_vertex);
 
-    static void ReverseEdges(Dataset&, const std::vector<int>& reversed_edges);
     static void CreateEdges(
         Graph&,
-        const std::vector<glm::vec3>& new_positions,
+        const Result&,
         const glm::vec2& _node_offset,
         bool _curved_edges = true);
 };
@@ -219,6 +314,9 @@ public:
     // Inherited via Layout
     bool Gui(IStructure&) override;
     static void Apply(IStructure&, int C, int l, float K, int n, float s, float threshold, bool quadratic, bool check_owners, CompatibilityFunction f);
+    // Bundles the given edge paths of the dataset in place, false when cancelled
+    static bool Compute(const Dataset&, const VectorOfEdgePaths&, int C, int l, float K, int n, float s, float threshold, bool quadratic,
+                        bool check_owners, CompatibilityFunction f, LayoutJob::Progress&);
 
 private:
     float m_K = 0.1f;          // Stiffnes
@@ -250,6 +348,8 @@ public:
     TSNELayout() { metrics = std::make_shared<DRQualityMetrics>(); };
     bool Gui(IStructure&) override;
     static void Apply(IStructure&, const int iterations, const int perplexity, const int scale);
+    // Positions per vertex, empty when cancelled
+    static std::vector<glm::vec3> Compute(const Dataset&, int iterations, int perplexity, int scale, LayoutJob::Progress&);
 
 private:
     int m_iterations = 1000;
@@ -263,6 +363,8 @@ public:
     MDSLayout() { metrics = std::make_shared<DRQualityMetrics>(); };
     bool Gui(IStructure&) override;
     static void Apply(IStructure&, const int iterations, const int scale);
+    // Positions per vertex, empty when cancelled
+    static std::vector<glm::vec3> Compute(const Dataset&, int iterations, int scale, LayoutJob::Progress&);
 
 private:
     int m_iterations = 1000;
@@ -0,0 +1,96 @@
+#include "precomp.h"
+
+namespace DataVis
+{
+//--------------------------------------------------------------
+// Progress
+//--------------------------------------------------------------
+void LayoutJob::Progress::Set(float _fraction)
+{
+	m_fraction = std::min(std::max(_fraction, 0.f), 1.f);
+}
+
+float LayoutJob::Progress::Get() const
+{
+	return m_fraction;
+}
+
+void LayoutJob::Progress::Cancel()
+{
+	m_cancelled = true;
+}
+
+bool LayoutJob::Progress::Cancelled() const
+{
+	return m_cancelled;
+}
+
+//--------------------------------------------------------------
+// Layout Job
+//--------------------------------------------------------------
+LayoutJob::~LayoutJob()
+{
+	Cancel();
+	if (m_result.valid())
+		m_result.wait();
+}
+
+void LayoutJob::Start(Work _work)
+{
+	if (Running())
+	{
+		Cancel();
+		m_result.wait();
+	}
+	m_progress = std::make_shared<Progress>();
+	m_result = ThreadPool::Global().Submit([work = std::move(_work), progress = m_progress]()
+	{
+		return work(*progress);
+	});
+}
+
+void LayoutJob::Cancel()
+{
+	if (m_progress)
+		m_progress->Cancel();
+}
+
+bool LayoutJob::Running() const
+{
+	return m_result.valid();
+}
+
+bool LayoutJob::Poll()
+{
+	if (!m_result.valid() || m_result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		return false;
+
+	Commit commit;
+	try
+	{
+		commit = m_result.get();
+	}
+	catch (std::exception& e)
+	{
+		std::cout << "W/LayoutJob::Poll: Layout failed: " << e.what() << std::endl;
+	}
+	if (!commit || m_progress->Cancelled())
+		return false;
+	commit();
+	return true;
+}
+
+void LayoutJob::Gui()
+{
+	if (!Running()) return;
+	if (m_progress->Cancelled())
+	{
+		ImGui::TextDisabled("Cancelling...");
+		return;
+	}
+	ImGui::ProgressBar(m_progress->Get(), ImVec2(200, 0));
+	ImGui::SameLine();
+	if (ImGui::Button("Cancel"))
+		Cancel();
+}
+} // namespace DataVis
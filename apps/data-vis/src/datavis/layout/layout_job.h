@@ -0,0 +1,54 @@
+#pragma once
+
+namespace DataVis
+{
+//--------------------------------------------------------------
+// Layout Job
+//--------------------------------------------------------------
+/**
+ * Runs the expensive part of a layout on the global thread pool. The work only sees a snapshot
+ * (the dataset, copied positions or edge paths) and returns a commit, which Poll runs on the main thread
+ * to write the result into the structure, e.g. through Node::SetNewPosition so the animation still plays.
+ */
+class LayoutJob
+{
+public:
+    // Shared between the job and the work, the work reports through it and checks it to stop early
+    class Progress
+    {
+    public:
+        // Fraction of the work done in [0, 1]
+        void Set(float fraction);
+        [[nodiscard]] float Get() const;
+        void Cancel();
+        [[nodiscard]] bool Cancelled() const;
+
+    private:
+        std::atomic<float> m_fraction = 0.f;
+        std::atomic<bool> m_cancelled = false;
+    };
+
+    using Commit = std::function<void()>;
+    // Runs on a worker thread, returns what to run on the main thread or null to discard the result
+    using Work = std::function<Commit(Progress&)>;
+
+    LayoutJob() = default;
+    LayoutJob(const LayoutJob&) = delete;
+    LayoutJob& operator=(const LayoutJob&) = delete;
+    // Cancels and waits for the work, the commit is dropped
+    ~LayoutJob();
+
+    // Cancels the running work first, if any
+    void Start(Work);
+    void Cancel();
+    [[nodiscard]] bool Running() const;
+    // Main thread, runs the commit once the work finished, true when a result was committed
+    bool Poll();
+    // Progress bar and cancel button
+    void Gui();
+
+private:
+    std::shared_ptr<Progress> m_progress;
+    std::future<Commit> m_result;
+};
+} // namespace DataVis
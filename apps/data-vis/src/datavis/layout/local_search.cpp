@@ -32,6 +32,8 @@ void LocalSearch::Apply(IStructure& _structure, int _iterations)
 	{
 		SwapPos(_structure, cost);
 	}
+	// Only the edges of the swapped nodes
+	_structure.UpdateEdges(true);
 }
 
 float LocalSearch::CalculateCost(const IStructure& _structure)
@@ -50,37 +52,26 @@ float LocalSearch::CalculateCost(const IStructure& _structure)
 
 float LocalSearch::CalculateIncrementalCost(const IStructure& _structure, uint _idx0, uint _idx1)
 {
+	const auto pos0 = _structure.nodes[_idx0]->GetPosition();
+	const auto pos1 = _structure.nodes[_idx1]->GetPosition();
 	float cost = 0;
 	// Subtract cost of all edges before swap at both indices
-	cost -= CalculateNodeCost(_structure, _idx0);
-	cost -= CalculateNodeCost(_structure, _idx1);
-	// Temporarily swap the positions of the two nodes
-	const auto& node0 = _structure.nodes[_idx0];
-	const auto& node1 = _structure.nodes[_idx1];
-	const auto pos0 = node0->GetPosition();
-	const auto pos1 = node1->GetPosition();
-	node0->SetPosition(pos1);
-	node1->SetPosition(pos0);
-	// Add cost of all edges after swap at both indices
-	cost += CalculateNodeCost(_structure, _idx0);
-	cost += CalculateNodeCost(_structure, _idx1);
-	// Swap back
-	node0->SetPosition(pos0);
-	node1->SetPosition(pos1);
+	cost -= CalculateNodeCost(_structure, _idx0, pos0, _idx1, pos1);
+	cost -= CalculateNodeCost(_structure, _idx1, pos1, _idx0, pos0);
+	// Add cost of all edges after swap at both indices, the nodes are not moved so they stay clean
+	cost += CalculateNodeCost(_structure, _idx0, pos1, _idx1, pos0);
+	cost += CalculateNodeCost(_structure, _idx1, pos0, _idx0, pos1);
 	return cost;
 }
 
-float LocalSearch::CalculateNodeCost(const IStructure& _structure, uint _idx)
+float LocalSearch::CalculateNodeCost(const IStructure& _structure, uint _idx, const glm::vec3& _position, uint _other_idx, const glm::vec3& _other_position)
 {
 	float cost = 0;
 	const auto& node = _structure.nodes[_idx];
-	auto& neighbors = _structure.dataset->vertices[node->GetVertexIdx()]->outgoing_neighbors;
-	for (const auto& neighbor : neighbors)
+	for (const Neighbor neighbor : _structure.dataset->GetAdjacency().Outgoing(node->GetVertexIdx()))
 	{
-		auto& neighbor_node = _structure.nodes[neighbor.idx];
-		glm::vec3 start = node->GetPosition();
-		glm::vec3 end = neighbor_node->GetPosition();
-		cost += glm::distance(start, end);
+		glm::vec3 end = neighbor.idx == static_cast<VertexIdx>(_other_idx) ? _other_position : _structure.nodes[neighbor.idx]->GetPosition();
+		cost += glm::distance(_position, end);
 	}
 	return cost;
 }
@@ -3,34 +3,273 @@
 namespace DataVis
 {
 
+namespace
+{
+	constexpr float z_95 = 1.96f;
 
+	// Uniform ordered pair of two different vertices
+	std::pair<int, int> SamplePair( int _size, std::mt19937& _rng )
+	{
+		const int i = std::uniform_int_distribution<int>( 0, _size - 1 )( _rng );
+		int j = std::uniform_int_distribution<int>( 0, _size - 2 )( _rng );
+		if (j >= i) j++;
+		return { i, j };
+	}
 
-void GraphQualityMetrics::MetricGui()
-{
-	if (m_metrics.size() <= 0) return;
+	// Different vertices, uniform without replacement
+	std::vector<int> SampleAnchors( int _size, int _count, std::mt19937& _rng )
+	{
+		std::vector<int> vertices( _size );
+		std::iota( vertices.begin(), vertices.end(), 0 );
+		for (int k = 0; k < _count; k++)
+			std::swap( vertices[k], vertices[std::uniform_int_distribution<int>( k, _size - 1 )( _rng )] );
+		vertices.resize( _count );
+		return vertices;
+	}
+
+	// Sample standard deviation
+	double StandardDeviation( const std::vector<double>& _samples )
+	{
+		if (_samples.size() < 2) return 0;
+		const double mean = std::accumulate( _samples.begin(), _samples.end(), 0. ) / _samples.size();
+		double sum = 0;
+		for (double x : _samples)
+			sum += (x - mean) * (x - mean);
+		return std::sqrt( sum / (_samples.size() - 1) );
+	}
+
+	// Estimates a sum over all vertices from the terms of the anchors, with the finite population correction
+	Estimate SumOverVertices( const std::vector<double>& _terms, int _size )
+	{
+		const double m = static_cast<double>( _terms.size() );
+		const double mean = std::accumulate( _terms.begin(), _terms.end(), 0. ) / m;
+		const double correction = _size > 1 ? std::sqrt( (_size - m) / (_size - 1) ) : 0;
+		return { static_cast<float>( _size * mean ),
+			static_cast<float>( z_95 * _size * StandardDeviation( _terms ) / std::sqrt( m ) * correction ) };
+	}
+
+	// Smallest and largest graph-theoretic distance between two different vertices, in one pass over the matrix
+	std::pair<float, float> DistanceRange( const DistanceCache::Matrix& _D, int _size )
+	{
+		float min = MAX_FLOAT, max = -MAX_FLOAT;
+		for (int i = 0; i < _size; i++)
+		{
+			for (int j = 0; j < _size; j++)
+			{
+				if (i == j) continue;
+				const float d_ij = static_cast<float>( DistanceCache::Distance( _D, i, j ) );
+				min = std::min( min, d_ij );
+				max = std::max( max, d_ij );
+			}
+		}
+		return { min, max };
+	}
+
+	// Smallest and largest distance between two different nodes, from the closest pair and the diameter of
+	// the convex hull. The sample has to be normalized by the range of all pairs, or its estimate is biased
+	std::pair<float, float> ProjectedRange( VectorOfNodes& _nodes )
+	{
+		const int size = static_cast<int>( _nodes.size() );
+		auto distance = [&]( int _i, int _j ) { return glm::length( _nodes[_i]->GetNewPosition() - _nodes[_j]->GetNewPosition() ); };
+		auto x = [&]( int _i ) { return _nodes[_i]->GetNewPosition().x; };
+		auto y = [&]( int _i ) { return _nodes[_i]->GetNewPosition().y; };
+
+		std::vector<int> order( size );
+		std::iota( order.begin(), order.end(), 0 );
+		std::sort( order.begin(), order.end(), [&]( int _a, int _b ) { return x( _a ) < x( _b ) || (x( _a ) == x( _b ) && y( _a ) < y( _b )); } );
+
+		// Closest pair, sweep in x over the nodes closer than the best distance so far
+		float min = MAX_FLOAT;
+		std::set<std::pair<float, int>> strip;
+		for (int k = 0, first = 0; k < size; k++)
+		{
+			const int i = order[k];
+			while (first < k && x( i ) - x( order[first] ) > min)
+				strip.erase( { y( order[first] ), order[first++] } );
+			for (auto it = strip.lower_bound( { y( i ) - min, -1 } ); it != strip.end() && it->first <= y( i ) + min; ++it)
+				min = std::min( min, distance( i, it->second ) );
+			strip.insert( { y( i ), i } );
+		}
 
+		// Convex hull, monotone chain
+		auto cross = [&]( int _o, int _a, int _b ) { return (x( _a ) - x( _o )) * (y( _b ) - y( _o )) - (y( _a ) - y( _o )) * (x( _b ) - x( _o )); };
+		std::vector<int> hull( 2 * size );
+		int h = 0;
+		for (int k = 0; k < size; k++)
+		{
+			while (h >= 2 && cross( hull[h - 2], hull[h - 1], order[k] ) <= 0) h--;
+			hull[h++] = order[k];
+		}
+		for (int k = size - 2, lower = h + 1; k >= 0; k--)
+		{
+			while (h >= lower && cross( hull[h - 2], hull[h - 1], order[k] ) <= 0) h--;
+			hull[h++] = order[k];
+		}
+		hull.resize( std::max( h - 1, 1 ) );
+		h = static_cast<int>( hull.size() );
+
+		// Diameter, rotating calipers over the antipodal pairs
+		float max = h < 2 ? distance( order.front(), order.back() ) : 0;
+		for (int i = 0, j = 1; i < h && h >= 2; i++)
+		{
+			const int next = (i + 1) % h;
+			while (std::abs( cross( hull[i], hull[next], hull[(j + 1) % h] ) ) > std::abs( cross( hull[i], hull[next], hull[j] ) ))
+				j = (j + 1) % h;
+			max = std::max( { max, distance( hull[i], hull[j] ), distance( hull[next], hull[j] ) } );
+		}
+		return { min, max };
+	}
+
+	// Empty Shepard histogram up to the largest finite graph-theoretic and projected distance
+	ShepardDensity ShepardBounds( IStructure& _structure, int _bins )
+	{
+		const auto& dataset = *_structure.dataset;
+		const auto neighbors = dataset.GetDistanceCache().GetNeighbors( dataset );
+
+		ShepardDensity density;
+		density.bins = _bins;
+		density.counts.assign( _bins * _bins, 0 );
+		if (_structure.nodes.size() < 2) return density;
+		for (const auto& list : *neighbors)
+		{
+			// The lists are sorted, pairs without a path are at the end
+			auto last = std::find_if( list.rbegin(), list.rend(), []( const std::pair<int, double>& _n ) { return _n.second < MAX_FLOAT; } );
+			if (last != list.rend()) density.max_distance = std::max( density.max_distance, static_cast<float>( last->second ) );
+		}
+		density.max_projected = ProjectedRange( _structure.nodes ).second;
+		return density;
+	}
+
+	// Bin of a vertex pair in the Shepard histogram, -1 for pairs without a path
+	int ShepardBin( const ShepardDensity& _density, double _distance, float _projected )
+	{
+		if (_distance >= MAX_FLOAT) return -1;
+		auto bin = [&]( float _value, float _max ) { return _max > 0 ? std::min( static_cast<int>( _value / _max * _density.bins ), _density.bins - 1 ) : 0; };
+		const int row = _density.bins - 1 - bin( _projected, _density.max_projected );
+		return row * _density.bins + bin( static_cast<float>( _distance ), _density.max_distance );
+	}
+
+	// Trustworthiness and continuity terms of the vertices in one parallel pass, they share the K nearest neighbor query.
+	// A term sums the ranks beyond K of the projected K nearest neighbors that are no original K nearest neighbors,
+	// or of the original K nearest neighbors that are no projected K nearest neighbors
+	std::pair<std::vector<double>, std::vector<double>> NeighborhoodTerms( IStructure& _structure, const std::vector<int>& _vertices, int _K )
+	{
+		auto& nodes = _structure.nodes;
+		const auto& dataset = *_structure.dataset;
+		const auto neighbors = dataset.GetDistanceCache().GetNeighbors( dataset );
+		const auto ranks = dataset.GetDistanceCache().GetRanks( dataset );
+		const auto& v_i_K = *neighbors;
+
+		std::vector<glm::vec2> points( nodes.size() );
+		for (int i = 0; i < nodes.size(); i++)
+			points[i] = glm::vec2( nodes[i]->GetNewPosition() );
+		KdTree tree;
+		tree.Build( points );
+		// Order of the tree, squared distance and ties in increasing index
+		auto key = [&]( int _i, int _j )
+		{
+			const glm::vec2 d = points[_j] - points[_i];
+			return std::pair<float, int>( d.x * d.x + d.y * d.y, _j );
+		};
+
+		std::vector<double> trustworthiness( _vertices.size() ), continuity( _vertices.size() );
+		ThreadPool::Global().ParallelFor( 0, static_cast<int>( _vertices.size() ), [&]( int _k )
+		{
+			const int i = _vertices[_k];
+			const int K = std::min( _K, static_cast<int>( v_i_K[i].size() ) );
+			std::vector<std::pair<float, int>> m_i_K;
+			tree.Nearest( points[i], i, K, m_i_K );
+
+			// False neighbors, their original rank is a lookup
+			int sum = 0;
+			for (const auto& [distance, j] : m_i_K)
+			{
+				const int rank = (*ranks)[i][j];
+				if (rank >= K) sum += rank - K;
+			}
+			trustworthiness[_k] = sum;
+
+			// Missing neighbors, their projected rank is the number of nodes closer to i
+			sum = 0;
+			for (int j = 0; j < K; j++)
+			{
+				const int neighbor = v_i_K[i][j].first;
+				if (std::none_of( m_i_K.begin(), m_i_K.end(), [&]( const std::pair<float, int>& _m ) { return _m.second == neighbor; } ))
+					sum += tree.CountCloser( points[i], i, key( i, neighbor ) ) - K;
+			}
+			continuity[_k] = sum;
+		} );
+		return { trustworthiness, continuity };
+	}
+}
+
+//--------------------------------------------------------------
+// Quality Metrics
+//--------------------------------------------------------------
+void IQualityMetrics::MetricTable( const char* _id )
+{
 	static ImGuiTableFlags flags = ImGuiTableFlags_BordersV | ImGuiTableFlags_BordersOuterH | ImGuiTableFlags_RowBg
 		| ImGuiTableFlags_ContextMenuInBody;
 
+	// The confidence intervals get their own column
+	const bool intervals = std::any_of( m_metrics.begin(), m_metrics.end(), []( const Metric& _metric ) { return !_metric.interval.empty(); } );
+
 	ImGui::PushStyleVar( ImGuiStyleVar_CellPadding, ImVec2( 3, 5 ) );
-	if (ImGui::BeginTable( "Quality Metrics", 2, flags ))
+	if (ImGui::BeginTable( _id, intervals ? 3 : 2, flags ))
 	{
-		for (const auto& [k, v] : m_metrics)
+		for (const auto& metric : m_metrics)
 		{
 			ImGui::TableNextRow();
 			// Column 
 			ImGui::TableNextColumn();
 			ImGui::PushStyleColor( ImGuiCol_Text, IM_COL32( 123, 123, 123, 255 ) );
-			ImGui::Text( k.c_str() );
+			ImGui::Text( metric.name.c_str() );
 			ImGui::PopStyleColor();
 			// Column
 			ImGui::TableNextColumn();
-			ImGui::Text( v.c_str() );
+			ImGui::Text( metric.value.c_str() );
+			if (!intervals) continue;
+			// Column
+			ImGui::TableNextColumn();
+			ImGui::Text( metric.interval.c_str() );
 		}
 		ImGui::EndTable();
 	}
 	ImGui::PopStyleVar();
+}
+
+void IQualityMetrics::AddMetric( const std::string& _name, const Estimate& _estimate )
+{
+	m_metrics.push_back( { _name, std::to_string( _estimate.value ),
+		m_approximate && _estimate.interval > 0 ? "+/- " + std::to_string( _estimate.interval ) : "" } );
+}
+
+bool IQualityMetrics::SamplingGui()
+{
+	bool changed = ImGui::Checkbox( "Approximate Metrics", &m_approximate );
+	if (m_approximate)
+	{
+		if (ImGui::InputInt( "Sample Pairs", &m_sample_pairs, 10000, 100000, ImGuiInputTextFlags_EnterReturnsTrue ))
+		{
+			m_sample_pairs = std::max( m_sample_pairs, 100 );
+			changed = true;
+		}
+		if (ImGui::IsItemHovered())
+			ImGui::SetTooltip( "Vertex pairs per metric, intervals are 95%% confidence" );
+	}
+	return changed;
+}
 
+//--------------------------------------------------------------
+// Graph Quality Metrics
+//--------------------------------------------------------------
+void GraphQualityMetrics::MetricGui( IStructure& _structure )
+{
+	if (m_metrics.size() <= 0) return;
+
+	if (SamplingGui())
+		ComputeMetrics( _structure );
+	MetricTable( "Quality Metrics" );
 }
 
 void GraphQualityMetrics::ComputeMetrics( IStructure& _structure )
@@ -38,36 +277,110 @@ void GraphQualityMetrics::ComputeMetrics( IStructure& _structure )
 	m_metrics.clear();
 
 	auto& crossing_data = Crossings( _structure );
-	m_metrics.emplace_back( "# of Crossings", std::to_string( crossing_data.first ) );
+	m_metrics.push_back( { "# of Crossings", std::to_string( crossing_data.first ) } );
 	if(crossing_data.first > 0)
-		m_metrics.emplace_back( "Crossing Resolution", std::to_string( crossing_data.second ) );
-	m_metrics.emplace_back( "Stress", std::to_string( Stress( _structure ) ) );
+		m_metrics.push_back( { "Crossing Resolution", std::to_string( crossing_data.second ) } );
+	if (m_approximate)
+		AddMetric( "Stress", Stress( _structure, m_sample_pairs, m_sample_seed ) );
+	else
+		AddMetric( "Stress", { Stress( _structure ) } );
 }
 
-// https://stackoverflow.com/questions/14176776/find-out-if-2-lines-intersect
 std::pair<int, float> GraphQualityMetrics::Crossings( IStructure& _structure )
 {
-	auto& edges = _structure.edges;
-
-	int crossings = 0;
-	float min_angle = MAX_FLOAT;
+	return Crossings( _structure.edges );
+}
 
-	// Loop over all pairs
-	for (int i = 0; i < edges.size() - 1; i++)
+// Segments are binned into a uniform grid over their bounding box and only segments sharing a cell
+// are tested. Two segments share a rectangle of cells, the pair is only tested in its lowest cell
+// so every pair is counted once. The rows of the grid are split over the threads
+// https://stackoverflow.com/questions/14176776/find-out-if-2-lines-intersect
+std::pair<int, float> GraphQualityMetrics::Crossings( const VectorOfEdgePaths& _edges )
+{
+	struct Segment
 	{
-		for (int j = i + 1; j < edges.size(); j++)
+		glm::vec3 p, q;
+		int edge;
+		int x0, y0, x1, y1; // Cells covered by the bounding box
+	};
+
+	// Segments with a non-finite point cannot be binned, they are left out
+	std::vector<Segment> segments;
+	glm::vec2 min( MAX_FLOAT ), max( -MAX_FLOAT );
+	float extent = 0;
+	for (int e = 0; e < _edges.size(); e++)
+	{
+		const auto& points = _edges[e]->points;
+		for (int k = 0; k + 1 < points.size(); k++)
 		{
-			auto& edge_1 = edges[i]->points;
-			auto& edge_2 = edges[j]->points;
+			const auto& p = points[k].new_value;
+			const auto& q = points[k + 1].new_value;
+			if (!std::isfinite( p.x ) || !std::isfinite( p.y ) || !std::isfinite( q.x ) || !std::isfinite( q.y )) continue;
+			segments.push_back( { p, q, e } );
+			min = glm::min( min, glm::min( glm::vec2( p ), glm::vec2( q ) ) );
+			max = glm::max( max, glm::max( glm::vec2( p ), glm::vec2( q ) ) );
+			extent += std::max( std::abs( q.x - p.x ), std::abs( q.y - p.y ) );
+		}
+	}
+	if (segments.size() < 2) return { 0, MAX_FLOAT };
+
+	// A cell is at least as large as the average segment, and holds a few segments on average
+	const float count = static_cast<float>( segments.size() );
+	const glm::vec2 size = max - min;
+	float cell_size = std::max( extent / count, std::sqrt( size.x * size.y / count ) );
+	if (!(cell_size > 0)) cell_size = std::max( std::max( size.x, size.y ), 1.f );
+	const int max_cells = static_cast<int>( std::sqrt( 4 * count ) ) + 1;
+	const int nx = std::clamp( static_cast<int>( std::ceil( size.x / cell_size ) ), 1, max_cells );
+	const int ny = std::clamp( static_cast<int>( std::ceil( size.y / cell_size ) ), 1, max_cells );
+	auto cell_x = [&]( float _x ) { return std::min( static_cast<int>( ( _x - min.x ) / cell_size ), nx - 1 ); };
+	auto cell_y = [&]( float _y ) { return std::min( static_cast<int>( ( _y - min.y ) / cell_size ), ny - 1 ); };
+
+	// Segments per cell, counted first
+	std::vector<int> cell_offsets( nx * ny + 1, 0 );
+	for (auto& s : segments)
+	{
+		s.x0 = cell_x( std::min( s.p.x, s.q.x ) );
+		s.x1 = cell_x( std::max( s.p.x, s.q.x ) );
+		s.y0 = cell_y( std::min( s.p.y, s.q.y ) );
+		s.y1 = cell_y( std::max( s.p.y, s.q.y ) );
+		for (int y = s.y0; y <= s.y1; y++)
+			for (int x = s.x0; x <= s.x1; x++)
+				cell_offsets[y * nx + x + 1]++;
+	}
+	for (int c = 0; c < nx * ny; c++)
+		cell_offsets[c + 1] += cell_offsets[c];
+	std::vector<int> cell_segments( cell_offsets.back() );
+	{
+		std::vector<int> fill( cell_offsets.begin(), cell_offsets.end() - 1 );
+		for (int i = 0; i < segments.size(); i++)
+			for (int y = segments[i].y0; y <= segments[i].y1; y++)
+				for (int x = segments[i].x0; x <= segments[i].x1; x++)
+					cell_segments[fill[y * nx + x]++] = i;
+	}
 
-			for (int k1 = 0; k1 < edge_1.size() - 1; k1++)
+	std::vector<int> row_crossings( ny, 0 );
+	std::vector<float> row_min_angle( ny, MAX_FLOAT );
+	ThreadPool::Global().ParallelFor( 0, ny, [&]( int _y )
+	{
+		int crossings = 0;
+		float min_angle = MAX_FLOAT;
+		for (int x = 0; x < nx; x++)
+		{
+			const int begin = cell_offsets[_y * nx + x], end = cell_offsets[_y * nx + x + 1];
+			for (int a = begin; a < end; a++)
 			{
-				for (int k2 = 0; k2 < edge_2.size() - 1; k2++)
+				for (int b = a + 1; b < end; b++)
 				{
-					auto& p1 = edge_1[k1].new_value;
-					auto& p2 = edge_1[k1 + 1].new_value;
-					auto& q1 = edge_2[k2].new_value;
-					auto& q2 = edge_2[k2 + 1].new_value;
+					const Segment* s1 = &segments[cell_segments[a]];
+					const Segment* s2 = &segments[cell_segments[b]];
+					if (s1->edge == s2->edge) continue;
+					if (std::max( s1->x0, s2->x0 ) != x || std::max( s1->y0, s2->y0 ) != _y) continue;
+					if (s1->edge > s2->edge) std::swap( s1, s2 );
+
+					const auto& p1 = s1->p;
+					const auto& p2 = s1->q;
+					const auto& q1 = s2->p;
+					const auto& q2 = s2->q;
 
 					if ((((q1.x - p1.x) * (p2.y - p1.y) - (q1.y - p1.y) * (p2.x - p1.x))
 						* ((q2.x - p1.x) * (p2.y - p1.y) - (q2.y - p1.y) * (p2.x - p1.x)) < 0)
@@ -77,22 +390,32 @@ std::pair<int, float> GraphQualityMetrics::Crossings( IStructure& _structure )
 					{
 						// Segments intersect
 						crossings++;
-						auto& p = glm::normalize( p2 - p1 );
-						auto& q = glm::normalize( q2 - q1 );
-						float angle = acos( glm::dot( p, q ) );
-						min_angle = min( min_angle, angle );
+						const glm::vec3 p = glm::normalize( p2 - p1 );
+						const glm::vec3 q = glm::normalize( q2 - q1 );
+						const float angle = acos( glm::dot( p, q ) );
+						min_angle = std::min( min_angle, angle );
 					}
 				}
 			}
 		}
+		row_crossings[_y] = crossings;
+		row_min_angle[_y] = min_angle;
+	} );
+
+	int crossings = 0;
+	float min_angle = MAX_FLOAT;
+	for (int y = 0; y < ny; y++)
+	{
+		crossings += row_crossings[y];
+		min_angle = std::min( min_angle, row_min_angle[y] );
 	}
 	return { crossings, min_angle };
 }
 
 float GraphQualityMetrics::Stress( IStructure& _structure )
 {
-	std::unique_ptr<smat::Matrix<double>> D;
-	FloydWarshall( *_structure.dataset, D );
+	const auto& dataset = *_structure.dataset;
+	const auto D = dataset.GetDistanceCache().GetMatrix( dataset );
 
 	auto& nodes = _structure.nodes;
 
@@ -105,7 +428,7 @@ float GraphQualityMetrics::Stress( IStructure& _structure )
 		for (int j = 0; j < nodes.size(); j++)
 		{
 			if (i == j) continue;
-			float d_ij = D->get( i, j );
+			float d_ij = DistanceCache::Distance( *D, i, j );
 			float projected = glm::length( nodes[i]->GetNewPosition() - nodes[j]->GetNewPosition() );
 			d_ij_min = min( d_ij_min, d_ij );
 			d_ij_max = max( d_ij_max, d_ij );
@@ -119,7 +442,7 @@ float GraphQualityMetrics::Stress( IStructure& _structure )
 	{
 		for (int j = i + 1; j < nodes.size(); j++)
 		{
-			float d_ij = D->get( i, j );
+			float d_ij = DistanceCache::Distance( *D, i, j );
 			glm::vec3 X_i = nodes[i]->GetNewPosition();
 			glm::vec3 X_j = nodes[j]->GetNewPosition();
 			float projected = glm::length( X_i - X_j );
@@ -134,48 +457,66 @@ float GraphQualityMetrics::Stress( IStructure& _structure )
 	return sum;
 }
 
-//--------------------------------------------------------------
-// DR Quality Metrics
-//--------------------------------------------------------------
-DRQualityMetrics::~DRQualityMetrics()
+Estimate GraphQualityMetrics::Stress( IStructure& _structure, int _sample_pairs, uint _seed )
 {
-	delete m_shepard_xs;
-	delete m_shepard_ys;
+	auto& nodes = _structure.nodes;
+	const int size = static_cast<int>( nodes.size() );
+	const double pairs = 0.5 * size * (size - 1.);
+	if (size < 2 || _sample_pairs >= pairs) return { Stress( _structure ) };
+
+	const auto& dataset = *_structure.dataset;
+	const auto D = dataset.GetDistanceCache().GetMatrix( dataset );
+
+	const auto [d_ij_min, d_ij_max] = DistanceRange( *D, size );
+	const auto [projected_min, projected_max] = ProjectedRange( nodes );
+
+	std::mt19937 rng( _seed );
+	std::vector<double> terms( _sample_pairs );
+	for (int k = 0; k < _sample_pairs; k++)
+	{
+		// The exact sum only reads the upper triangle, which differs from the lower one on directed graphs
+		auto [i, j] = SamplePair( size, rng );
+		if (i > j) std::swap( i, j );
+		const float d_ij = ofMap( DistanceCache::Distance( *D, i, j ), d_ij_min, d_ij_max, 1, 2 );
+		const float projected = glm::length( nodes[i]->GetNewPosition() - nodes[j]->GetNewPosition() );
+		const float difference = ofMap( projected, projected_min, projected_max, 1, 2 ) - d_ij;
+		terms[k] = 1 / (d_ij * d_ij) * (difference * difference);
+	}
+	// The pairs are drawn with replacement, unlike the anchors of SumOverVertices, so the samples are
+	// independent and the interval has no finite population correction
+	const double mean = std::accumulate( terms.begin(), terms.end(), 0. ) / _sample_pairs;
+	return { static_cast<float>( pairs * mean ),
+		static_cast<float>( z_95 * pairs * StandardDeviation( terms ) / std::sqrt( _sample_pairs ) ) };
 }
 
-void DRQualityMetrics::MetricGui()
+//--------------------------------------------------------------
+// DR Quality Metrics
+//--------------------------------------------------------------
+void DRQualityMetrics::MetricGui(IStructure& _structure)
 {
 	if (m_metrics.size() <= 0) return;
 
-	static ImGuiTableFlags flags = ImGuiTableFlags_BordersV | ImGuiTableFlags_BordersOuterH | ImGuiTableFlags_RowBg
-		| ImGuiTableFlags_ContextMenuInBody;
+	if (SamplingGui())
+		ComputeMetrics(_structure);
+	MetricTable("DR Quality Metrics");
 
-	ImGui::PushStyleVar(ImGuiStyleVar_CellPadding, ImVec2(3, 5));
-	if (ImGui::BeginTable("DR Quality Metrics", 2, flags))
+	ImGui::Checkbox("Shepard Scatter", &m_shepard_scatter);
+	if (m_shepard_scatter && ImGui::InputInt("Scatter Points", &m_shepard_scatter_count, 1000, 10000, ImGuiInputTextFlags_EnterReturnsTrue))
 	{
-		for (const auto& [k, v] : m_metrics)
-		{
-			ImGui::TableNextRow();
-			// Column 
-			ImGui::TableNextColumn();
-			ImGui::PushStyleColor(ImGuiCol_Text, IM_COL32(123, 123, 123, 255));
-			ImGui::Text(k.c_str());
-			ImGui::PopStyleColor();
-			// Column
-			ImGui::TableNextColumn();
-			ImGui::Text(v.c_str());
-		}
-		ImGui::EndTable();
+		m_shepard_scatter_count = std::max(m_shepard_scatter_count, 0);
+		ComputeShepardPoints(_structure);
 	}
-	ImGui::PopStyleVar();
 
 	if (ImPlot::BeginPlot("Shepard Plot"))
 	{
-		ImPlot::PlotScatter("Shepard Points", m_shepard_xs, m_shepard_ys, m_shepard_count);
-		/*ImPlot::PushStyleVar(ImPlotStyleVar_FillAlpha, 0.25f);
-		ImPlot::SetNextMarkerStyle(ImPlotMarker_Square, 6, ImPlot::GetColormapColor(1), IMPLOT_AUTO, ImPlot::GetColormapColor(1));
-		ImPlot::PlotScatter("Data 2", xs2, ys2, 50);
-		ImPlot::PopStyleVar();*/
+		const ImPlotPoint max(m_shepard.max_distance, m_shepard.max_projected);
+		ImPlot::SetupAxes("Graph Distance", "Projected Distance");
+		ImPlot::SetupAxesLimits(0, max.x, 0, max.y, ImPlotCond_Always);
+		ImPlot::PushColormap(ImPlotColormap_Viridis);
+		ImPlot::PlotHeatmap("Shepard Density", m_shepard_heatmap.data(), m_shepard.bins, m_shepard.bins, 0, 0, nullptr, ImPlotPoint(0, 0), max);
+		ImPlot::PopColormap();
+		if (m_shepard_scatter)
+			ImPlot::PlotScatter("Shepard Points", m_shepard_xs.data(), m_shepard_ys.data(), static_cast<int>(m_shepard_xs.size()));
 		ImPlot::EndPlot();
 	}
 }
@@ -184,24 +525,42 @@ void DRQualityMetrics::ComputeMetrics(IStructure& _structure)
 {
 	m_metrics.clear();
 
-	m_metrics.emplace_back("Normalized Stress", std::to_string(NormalizedStress(_structure)));
-	m_metrics.emplace_back("Trustworthiness", std::to_string(Trustworthiness(_structure, 10)));
-	m_metrics.emplace_back("Continuity", std::to_string(Continuity(_structure, 10)));
-
-	auto& shepard_points = ShepardPoints(_structure);
-	m_shepard_count = shepard_points.first.size();
-	delete m_shepard_xs;
-	delete m_shepard_ys;
-	m_shepard_xs = new float[m_shepard_count];
-	m_shepard_ys = new float[m_shepard_count];
-	std::copy(shepard_points.first.begin(), shepard_points.first.end(), m_shepard_xs);
-	std::copy(shepard_points.second.begin(), shepard_points.second.end(), m_shepard_ys);
+	if (m_approximate)
+	{
+		// An anchor costs as much as n vertex pairs
+		const int anchors = std::max(m_sample_pairs / std::max(static_cast<int>(_structure.nodes.size()), 1), 1);
+		AddMetric("Normalized Stress", NormalizedStress(_structure, m_sample_pairs, m_sample_seed));
+		const auto [trustworthiness, continuity] = TrustworthinessContinuity(_structure, 10, anchors, m_sample_seed);
+		AddMetric("Trustworthiness", trustworthiness);
+		AddMetric("Continuity", continuity);
+		m_shepard = Shepard(_structure, SHEPARD_BINS, m_sample_pairs, m_sample_seed);
+	}
+	else
+	{
+		AddMetric("Normalized Stress", { NormalizedStress(_structure) });
+		const auto [trustworthiness, continuity] = TrustworthinessContinuity(_structure, 10);
+		AddMetric("Trustworthiness", { trustworthiness });
+		AddMetric("Continuity", { continuity });
+		m_shepard = Shepard(_structure, SHEPARD_BINS);
+	}
+
+	// Most pairs fall in a few bins, the log keeps the others visible
+	m_shepard_heatmap.resize(m_shepard.counts.size());
+	std::transform(m_shepard.counts.begin(), m_shepard.counts.end(), m_shepard_heatmap.begin(), [](float _count) { return std::log10(1 + _count); });
+	ComputeShepardPoints(_structure);
+}
+
+void DRQualityMetrics::ComputeShepardPoints(IStructure& _structure)
+{
+	auto [xs, ys] = ShepardPoints(_structure, m_shepard_scatter_count, m_sample_seed);
+	m_shepard_xs = std::move(xs);
+	m_shepard_ys = std::move(ys);
 }
 
 float DRQualityMetrics::NormalizedStress(IStructure& _structure)
 {
-	std::unique_ptr<smat::Matrix<double>> D;
-	FloydWarshall(*_structure.dataset, D);
+	const auto& dataset = *_structure.dataset;
+	const auto D = dataset.GetDistanceCache().GetMatrix(dataset);
 
 	auto& nodes = _structure.nodes;
 
@@ -214,7 +573,7 @@ float DRQualityMetrics::NormalizedStress(IStructure& _structure)
 		for (int j = 0; j < nodes.size(); j++)
 		{
 			if (i == j) continue;
-			float delta_n = D->get( i, j );
+			float delta_n = DistanceCache::Distance( *D, i, j );
 			float delta_q = glm::length( nodes[i]->GetNewPosition() - nodes[j]->GetNewPosition());
 			delta_n_min = min( delta_n_min, delta_n );
 			delta_n_max = max( delta_n_max, delta_n );
@@ -232,7 +591,7 @@ float DRQualityMetrics::NormalizedStress(IStructure& _structure)
 		{
 			if (i == j) continue;
 			auto& x_j = nodes[j];
-			float delta_n = D->get(i, j);
+			float delta_n = DistanceCache::Distance(*D, i, j);
 			float delta_q = glm::length(x_i->GetNewPosition() - x_j->GetNewPosition());
 			delta_n = ofMap( delta_n, delta_n_min, delta_n_max, 0, 1 );
 			delta_q = ofMap( delta_q, delta_q_min, delta_q_max, 0, 1 );
@@ -246,8 +605,8 @@ float DRQualityMetrics::NormalizedStress(IStructure& _structure)
 
 std::pair<std::vector<float>, std::vector<float>> DRQualityMetrics::ShepardPoints(IStructure& _structure)
 {
-	std::unique_ptr<smat::Matrix<double>> D;
-	FloydWarshall(*_structure.dataset, D);
+	const auto& dataset = *_structure.dataset;
+	const auto D = dataset.GetDistanceCache().GetMatrix(dataset);
 
 	auto& nodes = _structure.nodes;
 	std::vector<float> xs;
@@ -258,7 +617,7 @@ std::pair<std::vector<float>, std::vector<float>> DRQualityMetrics::ShepardPoint
 		{
 			if (i == j) continue;
 			float delta_p = glm::length(nodes[i]->GetNewPosition() - nodes[j]->GetNewPosition());
-			float delta_n = D->get(i, j);
+			float delta_n = DistanceCache::Distance(*D, i, j);
 			xs.emplace_back(delta_n);
 			ys.emplace_back(delta_p);
 		}
@@ -266,111 +625,147 @@ std::pair<std::vector<float>, std::vector<float>> DRQualityMetrics::ShepardPoint
 	return { xs, ys };
 }
 
-float DRQualityMetrics::Trustworthiness(IStructure& _structure, int _K)
+Estimate DRQualityMetrics::NormalizedStress(IStructure& _structure, int _sample_pairs, uint _seed)
 {
 	auto& nodes = _structure.nodes;
-	// K nearest neighbors of vertex i before projection are:
-	// First K elements of v_i_K[i]
-	uint N = nodes.size();
-	qdtsne::NeighborList<int, double> v_i_K;
-	FloydWarshall(*_structure.dataset, v_i_K);
+	const int size = static_cast<int>(nodes.size());
+	if (size < 2 || _sample_pairs >= size * (size - 1.)) return { NormalizedStress(_structure) };
 
-	float sum = 0;
-	for (int i = 0; i < nodes.size(); i++)
-	{
-		std::vector<std::pair<int, double>> dists;
-		for (int j = 0; j < nodes.size(); j++)
-		{
-			if (i == j) continue;
-			float dist = glm::length(nodes[i]->GetNewPosition() - nodes[j]->GetNewPosition());
-			dists.emplace_back(j, dist);
-		}
-		std::sort(dists.begin(), dists.end(), [](std::pair<int, double> lhs, std::pair<int, double> rhs) {
-			return lhs.second < rhs.second;
-			});
+	const auto& dataset = *_structure.dataset;
+	const auto D = dataset.GetDistanceCache().GetMatrix(dataset);
 
-		// Loop over each point in m_i_K
-		for (int j = 0; j < _K; j++)
-		{
-			auto& pair = dists[j];
-			// Check if point in v_i_K
-			bool original_neighbour = false;
-			for (int k = 0; k < _K; k++)
-				if (v_i_K[i][k].first == pair.first)
-				{
-					original_neighbour = true;
-					break;
-				}
+	const auto [delta_n_min, delta_n_max] = DistanceRange(*D, size);
+	const auto [delta_q_min, delta_q_max] = ProjectedRange(nodes);
 
-			if (original_neighbour) continue;
+	// Ratio of two sums, the interval follows from the delta method
+	std::mt19937 rng(_seed);
+	std::vector<double> difs(_sample_pairs), norms(_sample_pairs);
+	for (int k = 0; k < _sample_pairs; k++)
+	{
+		const auto [i, j] = SamplePair(size, rng);
+		const float n = ofMap(DistanceCache::Distance(*D, i, j), delta_n_min, delta_n_max, 0, 1);
+		const float q = ofMap(glm::length(nodes[i]->GetNewPosition() - nodes[j]->GetNewPosition()), delta_q_min, delta_q_max, 0, 1);
+		difs[k] = (n - q) * (n - q);
+		norms[k] = n * n;
+	}
+	const double sum_dif = std::accumulate(difs.begin(), difs.end(), 0.);
+	const double sum = std::accumulate(norms.begin(), norms.end(), 0.);
+	const double ratio = sum_dif / sum;
+	std::vector<double> residuals(_sample_pairs);
+	for (int k = 0; k < _sample_pairs; k++)
+		residuals[k] = difs[k] - ratio * norms[k];
+	const double error = StandardDeviation(residuals) / std::sqrt(_sample_pairs) / (sum / _sample_pairs);
+	return { static_cast<float>(ratio), static_cast<float>(z_95 * error) };
+}
 
-			// We have a false neighbour
-			int rank = 0;
-			// Loop over the original dataset
-			for (int k = _K; k < v_i_K[i].size(); k++)
-				if (v_i_K[i][k].first == pair.first)
-				{
-					rank = k;
-					break;
-				}
+std::pair<std::vector<float>, std::vector<float>> DRQualityMetrics::ShepardPoints(IStructure& _structure, int _sample_pairs, uint _seed)
+{
+	auto& nodes = _structure.nodes;
+	const int size = static_cast<int>(nodes.size());
+	if (size < 2 || _sample_pairs >= size * (size - 1.)) return ShepardPoints(_structure);
 
-			sum += rank - _K;
-		}
+	const auto& dataset = *_structure.dataset;
+	const auto D = dataset.GetDistanceCache().GetMatrix(dataset);
+
+	std::mt19937 rng(_seed);
+	std::vector<float> xs(_sample_pairs);
+	std::vector<float> ys(_sample_pairs);
+	for (int k = 0; k < _sample_pairs; k++)
+	{
+		const auto [i, j] = SamplePair(size, rng);
+		xs[k] = DistanceCache::Distance(*D, i, j);
+		ys[k] = glm::length(nodes[i]->GetNewPosition() - nodes[j]->GetNewPosition());
 	}
-	return 1 - sum * 2 / static_cast<float>(N * _K * (2 * N - 3 * _K - 1));
+	return { xs, ys };
 }
 
-float DRQualityMetrics::Continuity(IStructure& _structure, int _K)
+ShepardDensity DRQualityMetrics::Shepard(IStructure& _structure, int _bins)
 {
 	auto& nodes = _structure.nodes;
-	// K nearest neighbors of vertex i before projection are:
-	// First K elements of v_i_K[i]
-	uint N = nodes.size();
-	qdtsne::NeighborList<int, double> v_i_K;
-	FloydWarshall(*_structure.dataset, v_i_K);
+	const int size = static_cast<int>(nodes.size());
+	const auto& dataset = *_structure.dataset;
+	const auto D = dataset.GetDistanceCache().GetMatrix(dataset);
 
-	float sum = 0;
-	for (int i = 0; i < nodes.size(); i++)
+	ShepardDensity density = ShepardBounds(_structure, _bins);
+	if (size < 2) return density;
+
+	// Every participant fills its own histogram. The pairs are ordered, the distances of directed graphs are not symmetric
+	const int chunks = std::max(static_cast<int>(ThreadPool::Global().Size()), 1);
+	std::vector<std::vector<int>> histograms(chunks, std::vector<int>(_bins * _bins, 0));
+	ThreadPool::Global().ParallelFor(0, chunks, [&](int _chunk)
 	{
-		std::vector<std::pair<int, double>> dists;
-		for (int j = 0; j < nodes.size(); j++)
-		{
-			if (i == j) continue;
-			float dist = glm::length(nodes[i]->GetNewPosition() - nodes[j]->GetNewPosition());
-			dists.emplace_back(j, dist);
-		}
-		std::sort(dists.begin(), dists.end(), [](std::pair<int, double> lhs, std::pair<int, double> rhs) {
-			return lhs.second < rhs.second;
-			});
+		auto& histogram = histograms[_chunk];
+		for (int i = _chunk; i < size; i += chunks)
+			for (int j = 0; j < size; j++)
+			{
+				if (i == j) continue;
+				const int bin = ShepardBin(density, DistanceCache::Distance(*D, i, j), glm::length(nodes[i]->GetNewPosition() - nodes[j]->GetNewPosition()));
+				if (bin >= 0) histogram[bin]++;
+			}
+	});
+	for (const auto& histogram : histograms)
+		for (int bin = 0; bin < histogram.size(); bin++)
+			density.counts[bin] += histogram[bin];
+	return density;
+}
 
-		// Loop over each point in v_i_K
-		for (int j = 0; j < _K; j++)
-		{
-			auto& pair = v_i_K[i][j];
-			// Check if point in m_i_K
-			bool projected_neighbour = false;
-			for (int k = 0; k < _K; k++)
-				if (dists[j].first == pair.first)
-				{
-					projected_neighbour = true;
-					break;
-				}
+ShepardDensity DRQualityMetrics::Shepard(IStructure& _structure, int _bins, int _sample_pairs, uint _seed)
+{
+	auto& nodes = _structure.nodes;
+	const int size = static_cast<int>(nodes.size());
+	if (size < 2 || _sample_pairs >= size * (size - 1.)) return Shepard(_structure, _bins);
 
-			if (projected_neighbour) continue;
+	const auto& dataset = *_structure.dataset;
+	const auto D = dataset.GetDistanceCache().GetMatrix(dataset);
 
-			// We have a missing neighbour
-			int rank = 0;
-			// Loop over the projected dataset
-			for (int k = _K; k < dists.size(); k++)
-				if (dists[k].first == pair.first)
-				{
-					rank = k;
-					break;
-				}
+	ShepardDensity density = ShepardBounds(_structure, _bins);
+	std::mt19937 rng(_seed);
+	for (int k = 0; k < _sample_pairs; k++)
+	{
+		const auto [i, j] = SamplePair(size, rng);
+		const int bin = ShepardBin(density, DistanceCache::Distance(*D, i, j), glm::length(nodes[i]->GetNewPosition() - nodes[j]->GetNewPosition()));
+		if (bin >= 0) density.counts[bin]++;
+	}
+	return density;
+}
 
-			sum += rank - _K;
-		}
+float DRQualityMetrics::Trustworthiness(IStructure& _structure, int _K)
+{
+	return TrustworthinessContinuity(_structure, _K).first;
+}
+
+float DRQualityMetrics::Continuity(IStructure& _structure, int _K)
+{
+	return TrustworthinessContinuity(_structure, _K).second;
+}
+
+std::pair<float, float> DRQualityMetrics::TrustworthinessContinuity(IStructure& _structure, int _K)
+{
+	const int N = static_cast<int>(_structure.nodes.size());
+	std::vector<int> vertices(N);
+	std::iota(vertices.begin(), vertices.end(), 0);
+	const auto [trustworthiness, continuity] = NeighborhoodTerms(_structure, vertices, _K);
+
+	const double scale = 2 / (static_cast<double>(N) * _K * (2. * N - 3. * _K - 1));
+	return { static_cast<float>(1 - std::accumulate(trustworthiness.begin(), trustworthiness.end(), 0.) * scale),
+		static_cast<float>(1 - std::accumulate(continuity.begin(), continuity.end(), 0.) * scale) };
+}
+
+std::pair<Estimate, Estimate> DRQualityMetrics::TrustworthinessContinuity(IStructure& _structure, int _K, int _sample_anchors, uint _seed)
+{
+	const int N = static_cast<int>(_structure.nodes.size());
+	if (_sample_anchors >= N)
+	{
+		const auto [trustworthiness, continuity] = TrustworthinessContinuity(_structure, _K);
+		return { { trustworthiness }, { continuity } };
 	}
-	return 1 - sum * 2 / static_cast<float>(N * _K * (2 * N - 3 * _K - 1));
+
+	std::mt19937 rng(_seed);
+	const auto [trustworthiness, continuity] = NeighborhoodTerms(_structure, SampleAnchors(N, _sample_anchors, rng), _K);
+	const auto trustworthiness_sum = SumOverVertices(trustworthiness, N);
+	const auto continuity_sum = SumOverVertices(continuity, N);
+	const float scale = 2 / (static_cast<float>(N) * _K * (2 * N - 3 * _K - 1));
+	return { { 1 - trustworthiness_sum.value * scale, trustworthiness_sum.interval * scale },
+		{ 1 - continuity_sum.value * scale, continuity_sum.interval * scale } };
 }
 }
\ No newline at end of file
@@ -2,14 +2,37 @@
 
 namespace DataVis
 {
+    // Value of a metric and the half width of its 95% confidence interval, zero when it was computed exactly
+    struct Estimate
+    {
+        float value = 0;
+        float interval = 0;
+    };
+
     class IQualityMetrics
     {
     public:
-        virtual void MetricGui() = 0;
+        virtual void MetricGui( IStructure& ) = 0;
         virtual void ComputeMetrics( IStructure& ) = 0;
     protected:
-        std::vector<std::pair<std::string, std::string>> m_metrics;
+        struct Metric
+        {
+            std::string name;
+            std::string value;
+            // Empty for exact metrics
+            std::string interval;
+        };
+
+        void MetricTable( const char* id );
+        void AddMetric( const std::string& name, const Estimate& );
+        // Returns true when the settings changed and the metrics have to be recomputed
+        bool SamplingGui();
 
+        std::vector<Metric> m_metrics;
+        // Approximate mode estimates the quadratic metrics from random vertex pairs
+        bool m_approximate = false;
+        int m_sample_pairs = 100000;
+        uint m_sample_seed = 0;
     };
 
     class GraphQualityMetrics : public IQualityMetrics
@@ -18,27 +41,58 @@ namespace DataVis
         GraphQualityMetrics() = default;
         // Returns <number of crossings, minimum crossing angle>
         static std::pair<int, float> Crossings( IStructure& );
+        static std::pair<int, float> Crossings( const VectorOfEdgePaths& );
         static float CrossingResolution( IStructure& );
         static float Stress( IStructure& );
-        void MetricGui() override;
+        // Estimated from sample_pairs uniform vertex pairs
+        static Estimate Stress( IStructure&, int sample_pairs, uint seed );
+        void MetricGui( IStructure& ) override;
         void ComputeMetrics( IStructure& ) override;
     };
 
+    // 2D histogram of the Shepard diagram, graph-theoretic distance against projected distance of the vertex pairs
+    struct ShepardDensity
+    {
+        int bins = 0;
+        // Row major, row 0 holds the largest projected distances like ImPlot::PlotHeatmap draws it
+        std::vector<float> counts;
+        // Both axes start at 0
+        float max_distance = 0;
+        float max_projected = 0;
+    };
+
     class DRQualityMetrics : public IQualityMetrics
     {
     public:
         DRQualityMetrics() = default;
-        virtual ~DRQualityMetrics();
         static float NormalizedStress( IStructure& );
         static std::pair<std::vector<float>, std::vector<float>> ShepardPoints( IStructure& );
         static float Trustworthiness( IStructure&, int K );
         static float Continuity( IStructure&, int K );
-        void MetricGui() override;
+        // Estimated from sample_pairs uniform vertex pairs
+        static Estimate NormalizedStress( IStructure&, int sample_pairs, uint seed );
+        static std::pair<std::vector<float>, std::vector<float>> ShepardPoints( IStructure&, int sample_pairs, uint seed );
+        // Over all ordered vertex pairs in parallel, pairs without a path are left out
+        static ShepardDensity Shepard( IStructure&, int bins );
+        static ShepardDensity Shepard( IStructure&, int bins, int sample_pairs, uint seed );
+        // Both in one pass, they share the K nearest neighbors in the projection
+        static std::pair<float, float> TrustworthinessContinuity( IStructure&, int K );
+        // Estimated from sample_anchors uniform vertices, each anchor costs as much as n vertex pairs
+        static std::pair<Estimate, Estimate> TrustworthinessContinuity( IStructure&, int K, int sample_anchors, uint seed );
+        void MetricGui( IStructure& ) override;
         void ComputeMetrics( IStructure& ) override;
 
     private:
-        float* m_shepard_xs;
-        float* m_shepard_ys;
-        int m_shepard_count;
+        void ComputeShepardPoints( IStructure& );
+
+        ShepardDensity m_shepard;
+        // Log scaled counts the heatmap draws
+        std::vector<float> m_shepard_heatmap;
+        // Random pairs drawn over the heatmap
+        bool m_shepard_scatter = false;
+        int m_shepard_scatter_count = 5000;
+        std::vector<float> m_shepard_xs;
+        std::vector<float> m_shepard_ys;
+        static constexpr int SHEPARD_BINS = 64;
     };
 }
\ No newline at end of file
@@ -8,6 +8,7 @@ namespace DataVis
         m_oscm_heuristics.emplace_back("Barycenter", SugiyamaLayout::OSCMBarycenterHeuristic);
         m_oscm_heuristics.emplace_back("Median", SugiyamaLayout::OSCMMedianHeuristic);
         m_node_offset = {50, -200};
+        m_oscm_seed = static_cast<int>(Random::random_device());
     }
 
     //--------------------------------------------------------------
@@ -17,6 +18,16 @@ namespace DataVis
         if (ImGui::TreeNode("Sugiyama Layout"))
         {
             ImGui::InputInt("OSCM Iterations", &m_oscm_iterations);
+            ImGui::InputInt("OSCM Seed", &m_oscm_seed);
+            ImGui::Checkbox("Parallel OSCM Restarts", &m_parallel_oscm);
+            if (m_winning_seed)
+            {
+                // The winning restart again on its own, with the same layers and crossings
+                ImGui::Text("Crossings: %d, winning seed: %u", m_crossings, *m_winning_seed);
+                ImGui::SameLine();
+                if (!job.Running() && ImGui::Button("Reproduce"))
+                    active = Start(_structure, 1, *m_winning_seed, false);
+            }
             ImGui::InputFloat("Delta X", &m_node_offset.x);
             ImGui::InputFloat("Delta Y", &m_node_offset.y);
 
@@ -33,522 +44,678 @@ namespace DataVis
                 }
                 ImGui::EndCombo();
             }
+            const char* layerings[] = { "Longest Path", "Network Simplex" };
+            int layering_idx = static_cast<int>(m_layering);
+            if (ImGui::Combo("Layering", &layering_idx, layerings, IM_ARRAYSIZE(layerings)))
+                m_layering = static_cast<Layering>(layering_idx);
             ImGui::Checkbox("Curved Edges", &m_curved_edges);
+            ImGui::Checkbox("Compare Layerings", &m_compare_layerings);
 
-            if (ImGui::Button("Apply"))
+            // The downstream steps pay for every dummy vertex the layering adds
+            for (int i = 0; i < IM_ARRAYSIZE(layerings); i++)
             {
-                try
-                {
-                    Graph& graph = dynamic_cast<Graph&>(_structure);
-                    Apply(graph, m_oscm_heuristics[m_oscm_heuristic_idx].second, m_node_offset, m_oscm_iterations, m_curved_edges);
-                    metrics->ComputeMetrics(_structure);
-                    active = true;
-                }
-                catch (std::exception& e)
-                {
-                    std::cout << e.what() << std::endl;
-                }
+                if (!m_statistics[i]) continue;
+                ImGui::Text("%s: %d dummy vertices, layering %.1f ms, downstream %.1f ms%s", layerings[i],
+                            m_statistics[i]->dummy_vertices, m_statistics[i]->layering_ms, m_statistics[i]->downstream_ms,
+                            m_statistics[i]->layering_optimal ? "" : " (pivot limit, not optimal)");
+            }
+            if (m_statistics[0] && m_statistics[1])
+            {
+                const float saved = m_statistics[0]->layering_ms + m_statistics[0]->downstream_ms
+                    - m_statistics[1]->layering_ms - m_statistics[1]->downstream_ms;
+                ImGui::Text("Network Simplex saves %d dummy vertices and %.1f ms",
+                            m_statistics[0]->dummy_vertices - m_statistics[1]->dummy_vertices, saved);
             }
+
+            if (job.Running())
+                job.Gui();
+            else if (ImGui::Button("Apply"))
+                active = Start(_structure, m_oscm_iterations, static_cast<uint>(m_oscm_seed), m_compare_layerings);
             ImGui::TreePop();
         }
         return active;
     }
 
+    //--------------------------------------------------------------
+    bool SugiyamaLayout::Start(IStructure& _structure, int _oscm_iterations, uint _oscm_seed, bool _compare)
+    {
+        try
+        {
+            Graph& graph = dynamic_cast<Graph&>(_structure);
+            m_statistics[0].reset();
+            m_statistics[1].reset();
+            job.Start([this, &graph, dataset = graph.dataset, heuristic = m_oscm_heuristics[m_oscm_heuristic_idx].second,
+                layering = m_layering, compare = _compare, node_offset = m_node_offset,
+                oscm_iterations = _oscm_iterations, oscm_seed = _oscm_seed, parallel_oscm = m_parallel_oscm,
+                curved_edges = m_curved_edges, metrics = metrics](LayoutJob::Progress& _progress) -> LayoutJob::Commit
+            {
+                // The other layering runs on the same input and only its statistics are kept
+                std::optional<Statistics> other;
+                if (compare)
+                {
+                    const Layering other_layering = layering == Layering::LongestPath ? Layering::NetworkSimplex : Layering::LongestPath;
+                    other = Compute(*dataset, heuristic, other_layering, node_offset, oscm_iterations, oscm_seed,
+                                    parallel_oscm, _progress).statistics;
+                }
+                auto result = Compute(*dataset, heuristic, layering, node_offset, oscm_iterations, oscm_seed, parallel_oscm, _progress);
+                if (result.positions.empty()) return nullptr;
+                return [this, &graph, dataset, layering, other, result = std::move(result), node_offset, curved_edges, metrics]()
+                {
+                    if (graph.dataset != dataset) return;
+                    m_statistics[static_cast<int>(layering)] = result.statistics;
+                    m_statistics[1 - static_cast<int>(layering)] = other;
+                    m_winning_seed = result.winning_seed;
+                    m_crossings = result.crossings;
+                    Commit(graph, result, node_offset, curved_edges);
+                    metrics->ComputeMetrics(graph);
+                };
+            });
+            return true;
+        }
+        catch (std::exception& e)
+        {
+            std::cout << e.what() << std::endl;
+        }
+        return false;
+    }
+
     //--------------------------------------------------------------
     void SugiyamaLayout::Apply(Graph& _graph, const OSCMHeuristic& _heuristic, const glm::vec2& _node_offset,
-                         const int& _oscm_iterations, bool _curved_edges)
+                         const int& _oscm_iterations, bool _curved_edges, Layering _layering, uint _oscm_seed, bool _parallel_oscm)
+    {
+        LayoutJob::Progress progress;
+        Commit(_graph, Compute(*_graph.dataset, _heuristic, _layering, _node_offset, _oscm_iterations, _oscm_seed, _parallel_oscm, progress),
+               _node_offset, _curved_edges);
+    }
+
+    SugiyamaLayout::Result SugiyamaLayout::Compute(const Dataset& _dataset, const OSCMHeuristic& _heuristic, Layering _layering,
+                                                   const glm::vec2& _node_offset, int _oscm_iterations, uint _oscm_seed,
+                                                   bool _parallel_oscm, LayoutJob::Progress& _progress)
     {
-        Dataset copy = *_graph.dataset;
+        Statistics statistics;
+        Timer timer;
 
         // Step 01: Break cycles
-        std::vector<int> reversed_edges;
-        Dataset new_dataset = BreakCycles(copy, reversed_edges);
+        LayeredGraph graph;
+        graph.Init(_dataset);
+        BreakCycles(graph);
+        _progress.Set(.1f);
 
         // Step 02: Layer assignment
         std::vector<Layer> vertices_per_layer;
         Layer layer_per_vertex;
-        LayerAssignment(new_dataset, vertices_per_layer, layer_per_vertex);
-        AddDummyVertices(new_dataset, vertices_per_layer, layer_per_vertex);
+        timer.Reset();
+        if (_layering == Layering::NetworkSimplex)
+            statistics.layering_optimal = NetworkSimplexLayering(graph, vertices_per_layer, layer_per_vertex);
+        else
+            LayerAssignment(graph, vertices_per_layer, layer_per_vertex);
+        statistics.layering_ms = timer.ElapsedMs();
+        AddDummyVertices(graph, vertices_per_layer, layer_per_vertex);
+        statistics.dummy_vertices = graph.vertex_count - graph.dataset_vertex_count;
+        _progress.Set(.2f);
+        if (_progress.Cancelled()) return {};
 
         // Step 03: Crossing minimization
-        const int crossings = CrossingMinimization(new_dataset, vertices_per_layer, _heuristic, _oscm_iterations);
-        new_dataset.AddInfo("# crossings", std::to_string(crossings));
+        timer.Reset();
+        uint winning_seed = _oscm_seed;
+        const int crossings = CrossingMinimization(graph, vertices_per_layer, _heuristic, _oscm_iterations, _progress,
+                                                   _oscm_seed, _parallel_oscm, &winning_seed);
+        if (_progress.Cancelled()) return {};
 
         // Step 04: Vertex positioning
-        const auto x_per_vertex = VertexPositioning(new_dataset, vertices_per_layer, layer_per_vertex, _node_offset.x);
-
-        // Step 05: Reverse back reversed edges
-        ReverseEdges(new_dataset, reversed_edges);
-        
-        _graph.Load(std::make_shared<Dataset>(std::move(new_dataset)));
-        std::vector<glm::vec3> new_positions(new_dataset.vertices.size());
+        const auto x_per_vertex = VertexPositioning(graph, vertices_per_layer, _node_offset.x);
+        statistics.downstream_ms = timer.ElapsedMs();
+
+        Result result;
+        result.statistics = statistics;
+        result.crossings = crossings;
+        result.winning_seed = winning_seed;
+        result.positions.resize(graph.vertex_count);
         for (size_t y = 0; y < vertices_per_layer.size(); y++)
         {
             for (const int idx : vertices_per_layer[y])
+                result.positions[idx] = glm::vec3(x_per_vertex[idx], _node_offset.y * y, 0);
+        }
+
+        // The path of every edge of the dataset, following the dummy vertices in the layered direction
+        result.edge_count = _dataset.edges.size();
+        result.path_offsets.reserve(result.edge_count + 1);
+        result.path_offsets.push_back(0);
+        result.path_vertices.reserve(graph.from.size() + 3 * result.edge_count);
+        for (size_t e = 0; e < result.edge_count; e++)
+        {
+            const int begin = static_cast<int>(result.path_vertices.size());
+            result.path_vertices.push_back(-1);
+            result.path_vertices.push_back(graph.from[e]);
+            VertexIdx v = graph.to[e];
+            result.path_vertices.push_back(v);
+            while (graph.IsDummy(v))
             {
-                const auto new_pos = glm::vec3(x_per_vertex[idx], _node_offset.y * y, 0);
-                new_positions[idx] = new_pos;
-                const auto& node = _graph.nodes[idx];
-                node->SetNewPosition(new_pos);
+                // A dummy vertex has exactly one outgoing edge
+                v = graph.adjacency.Outgoing(v)[0].idx;
+                result.path_vertices.push_back(v);
             }
+            result.path_vertices.push_back(-1);
+            if (graph.reversed[e])
+                std::reverse(result.path_vertices.begin() + begin + 1, result.path_vertices.end() - 1);
+            result.path_offsets.push_back(static_cast<int>(result.path_vertices.size()));
         }
 
-        _graph.edges.resize(copy.edges.size());
-        CreateEdges(_graph, new_positions, _node_offset, _curved_edges);
-            
-        _graph.UpdateAABB();
+        // Step 05: Reverse back reversed edges
+        for (size_t e = 0; e < graph.from.size(); e++)
+            if (graph.reversed[graph.owner[e]]) std::swap(graph.from[e], graph.to[e]);
+        graph.BuildAdjacency();
+
+        for (size_t e = 0; e < result.edge_count; e++)
+        {
+            const int begin = result.path_offsets[e], end = result.path_offsets[e + 1];
+            const auto incoming = graph.adjacency.Incoming(result.path_vertices[begin + 1]);
+            const auto outgoing = graph.adjacency.Outgoing(result.path_vertices[end - 2]);
+            if (!incoming.empty()) result.path_vertices[begin] = incoming[0].idx;
+            if (!outgoing.empty()) result.path_vertices[end - 1] = outgoing[0].idx;
+        }
+
+        _progress.Set(1.f);
+        return result;
     }
 
-    void SugiyamaLayout::ReverseEdges(Dataset& _dataset, const std::vector<int>& _reversed_edges)
+    void SugiyamaLayout::Commit(Graph& _graph, const Result& _result, const glm::vec2& _node_offset, bool _curved_edges)
     {
-        const auto& vertices = _dataset.vertices;
-        for(const int edge_idx : _reversed_edges)
-        {
-            auto& edge = _dataset.edges[edge_idx];
-            int from_idx = edge.from_idx;
-            int to_idx = edge.to_idx;
-            const int old_idx = edge.idx;
-            
-            // Reverse first edge
-            RemoveNeighbors(_dataset, edge);
-            vertices[from_idx]->incoming_neighbors.emplace_back(to_idx, edge.idx);
-            vertices[to_idx]->outgoing_neighbors.emplace_back(from_idx, edge.idx);
-            edge.from_idx = to_idx;
-            edge.to_idx = from_idx;
-            
-            // v0 -> dum -> v1
-            while(vertices[to_idx]->id == DUMMY_ID)
-            {
-                const auto& outgoing_neigbors = vertices[to_idx]->outgoing_neighbors;
-                auto& edge = _dataset.edges[outgoing_neigbors[0].edge_idx];
-                from_idx = edge.from_idx;
-                to_idx = edge.to_idx;
-                
-                RemoveNeighbors(_dataset, edge);
-                vertices[from_idx]->incoming_neighbors.emplace_back(to_idx, edge.idx);
-                vertices[to_idx]->outgoing_neighbors.emplace_back(from_idx, edge.idx);
-                edge.from_idx = to_idx;
-                edge.to_idx = from_idx;
-                edge.idx = old_idx;
-            }            
-        }
+        // The dummy vertices only bend the edges, the nodes stay the vertices of the dataset
+        for (size_t i = 0; i < _graph.nodes.size(); i++)
+            _graph.nodes[i]->SetNewPosition(_result.positions[i]);
+
+        _graph.edges.resize(_result.edge_count);
+        CreateEdges(_graph, _result, _node_offset, _curved_edges);
+
+        _graph.UpdateAABB();
     }
 
-    void SugiyamaLayout::CreateEdges(Graph& _graph, const std::vector<glm::vec3>& _new_positions, const glm::vec2& _node_offset, bool _curved_edges)
+    void SugiyamaLayout::CreateEdges(Graph& _graph, const Result& _result, const glm::vec2& _node_offset, bool _curved_edges)
     {
         const auto& nodes = _graph.nodes;
-        const auto& dataset = *_graph.dataset;
-        // Create curves
-        const auto& vertices = dataset.vertices;
-        for(const auto& edge : dataset.edges)
+        const auto& positions = _result.positions;
+        const auto& path = _result.path_vertices;
+        for (size_t e = 0; e < _result.edge_count; e++)
         {
-            if(vertices[edge.from_idx]->id == DUMMY_ID)
-                continue;
+            const int begin = _result.path_offsets[e], end = _result.path_offsets[e + 1];
+            const VertexIdx before = path[begin], source = path[begin + 1];
+            const VertexIdx target = path[end - 2], after = path[end - 1];
 
-            _graph.edges[edge.idx] = std::make_shared<EdgePath>(edge.idx, _graph.dataset->GetKind());
-            const auto& edge_path = _graph.edges[edge.idx];
-            edge_path->Clear();
+            _graph.edges[e] = std::make_shared<EdgePath>(static_cast<int>(e), _graph.dataset->GetKind());
+            const auto& edge_path = _graph.edges[e];
             // Set line type
             if(_curved_edges)
             {
                 edge_path->SetStyle(EdgePath::Style::Curve);
                 // Add first control point
-            
-                const auto& incoming_neighbors = vertices[edge.from_idx]->incoming_neighbors;
-                if(!incoming_neighbors.empty())
-                    edge_path->SetStartCtrlPoint(_new_positions[incoming_neighbors[0].idx]);
+                if(before >= 0)
+                    edge_path->SetStartCtrlPoint(positions[before]);
                 else
-                    edge_path->SetStartCtrlPoint(_new_positions[edge.from_idx] - glm::vec3(0, _node_offset.y, 0));
+                    edge_path->SetStartCtrlPoint(positions[source] - glm::vec3(0, _node_offset.y, 0));
             }
             else
             {
                 edge_path->SetStyle(EdgePath::Style::Line);
             }
-            
-            // Add start vertex
-            edge_path->AddPoint(_new_positions[edge.from_idx]);
 
-            auto current_edge = edge;
-            while (vertices[current_edge.to_idx]->id == DUMMY_ID)
-            {
-                edge_path->AddPoint(_new_positions[current_edge.to_idx]);
-                auto& next_node = vertices[current_edge.to_idx];
-                // Only 1 outgoing edge
-                current_edge = dataset.edges[next_node->outgoing_neighbors[0].edge_idx];
-            } 
-            // Add end vertex
-            edge_path->AddPoint(_new_positions[current_edge.to_idx]);
-            edge_path->SetArrowOffset(nodes[current_edge.to_idx]->GetRadius() * 2);
+            // Add start vertex, the dummy vertices and the end vertex
+            for (int i = begin + 1; i < end - 1; i++)
+                edge_path->AddPoint(positions[path[i]]);
+            edge_path->SetArrowOffset(nodes[target]->GetRadius() * 2);
 
             if(_curved_edges)
             {
                 // Add last control point
-                const auto& neighbors = vertices[current_edge.to_idx]->outgoing_neighbors;
-                if(!neighbors.empty()) 
-                    edge_path->SetEndCtrlPoint(_new_positions[neighbors[0].idx]);
+                if(after >= 0)
+                    edge_path->SetEndCtrlPoint(positions[after]);
                 else
-                    edge_path->SetEndCtrlPoint(_new_positions[current_edge.to_idx] + glm::vec3(0, _node_offset.y, 0));
+                    edge_path->SetEndCtrlPoint(positions[target] + glm::vec3(0, _node_offset.y, 0));
             }
         }
     }
 
     //--------------------------------------------------------------
-    // Break Cycles
+    // Layered Graph
     //--------------------------------------------------------------
-    Dataset SugiyamaLayout::BreakCycles(Dataset& _dataset, std::vector<int>& _reversed_edges )
+    void SugiyamaLayout::LayeredGraph::Init(const Dataset& _dataset)
     {
-        // Make a copy
-        auto& vertices = _dataset.vertices;
+        dataset_vertex_count = vertex_count = static_cast<int>(_dataset.vertices.size());
+        const size_t edge_count = _dataset.edges.size();
+        from.resize(edge_count);
+        to.resize(edge_count);
+        owner.resize(edge_count);
+        reversed.assign(edge_count, false);
+        for (size_t e = 0; e < edge_count; e++)
+        {
+            // Undirected edges are laid out in the direction they were given
+            from[e] = _dataset.edges[e].from_idx;
+            to[e] = _dataset.edges[e].to_idx;
+            owner[e] = static_cast<EdgeIdx>(e);
+        }
+        BuildAdjacency();
+    }
 
-        // Create a new dataset without any edges
-        Dataset new_dataset;
-        new_dataset = _dataset;
-        new_dataset.vertices.clear();        
-        auto& new_vertices = new_dataset.vertices;
+    void SugiyamaLayout::LayeredGraph::BuildAdjacency()
+    {
+        // Self loops are left out, they do not take part in the layering
+        adjacency.Build(from, to, vertex_count);
+    }
 
-        for (auto& vertex : vertices)
+    //--------------------------------------------------------------
+    // Break Cycles
+    //--------------------------------------------------------------
+    // Eades, Lin, Smyth, 1993 https://doi.org/10.1016/0020-0190(93)90079-O
+    void SugiyamaLayout::BreakCycles(LayeredGraph& _graph)
+    {
+        const auto& adjacency = _graph.adjacency;
+        const int size = _graph.vertex_count;
+        std::vector<int> out_degree(size), in_degree(size);
+        int max_out = 0, max_in = 0;
+        for (int v = 0; v < size; v++)
         {
-            new_vertices.emplace_back(std::make_shared<Vertex>());
-            auto& v = *new_vertices.back();
-            v.id = vertex->id;
-            v.idx = vertex->idx;
-            v.attributes = vertex->attributes;
+            out_degree[v] = adjacency.Outgoing(v).size();
+            in_degree[v] = adjacency.Incoming(v).size();
+            max_out = std::max(max_out, out_degree[v]);
+            max_in = std::max(max_in, in_degree[v]);
         }
 
-        // While there are unvisited vertices
-        Vertex dummy;
-        while (HasUnvisited([](Vertex&) { return true; }, vertices, dummy))
+        // Sinks and sources wait on a stack, once a sink always a sink. The other vertices are in
+        // a doubly linked bucket per out - in degree, the bucket of a vertex changes by one per removed edge
+        std::vector<int> sinks, sources;
+        std::vector<int> head(max_out + max_in + 1, -1);
+        std::vector<int> next(size, -1), prev(size, -1), bucket(size, -1);
+        std::vector<bool> removed(size, false);
+        int max_bucket = -1;
+
+        auto unlink = [&](int _v)
+        {
+            if (bucket[_v] < 0) return;
+            if (prev[_v] >= 0) next[prev[_v]] = next[_v];
+            else head[bucket[_v]] = next[_v];
+            if (next[_v] >= 0) prev[next[_v]] = prev[_v];
+            bucket[_v] = -1;
+        };
+        auto place = [&](int _v)
         {
-            // Remove sinks
-            Vertex sink;
-            while (HasUnvisited(SugiyamaLayout::IsSink, vertices, sink))
+            unlink(_v);
+            if (out_degree[_v] == 0)
+                sinks.push_back(_v);
+            else if (in_degree[_v] == 0)
+                sources.push_back(_v);
+            else
             {
-                for (auto& neighbor : sink.incoming_neighbors)
-                {
-                    // Add edge to new dataset
-                    new_vertices[sink.idx]->incoming_neighbors.push_back(neighbor);
-                    Neighbor rev_neighbor = neighbor;
-                    rev_neighbor.idx = sink.idx;
-                    new_vertices[neighbor.idx]->outgoing_neighbors.push_back(rev_neighbor);
-
-                    // Remove edge from old dataset
-                    auto& outgoing = vertices[neighbor.idx]->outgoing_neighbors;
-                    for (int i = 0; i < outgoing.size(); i++)
-                    {
-                        if (outgoing[i].edge_idx == neighbor.edge_idx)
-                        {
-                            outgoing[i] = outgoing[outgoing.size() - 1];
-                            outgoing.pop_back();
-                        }
-                    }
-                }
-                vertices[sink.idx]->incoming_neighbors.clear();
-                vertices[sink.idx]->idx = VISITED_IDX;
+                const int b = out_degree[_v] - in_degree[_v] + max_in;
+                bucket[_v] = b;
+                prev[_v] = -1;
+                next[_v] = head[b];
+                if (head[b] >= 0) prev[head[b]] = _v;
+                head[b] = _v;
+                max_bucket = std::max(max_bucket, b);
             }
-
-            // Delete all isolated nodes
-            for (auto& v : vertices)
-                if (v->incoming_neighbors.empty() && v->outgoing_neighbors.empty())
-                    v->idx = VISITED_IDX;
-
-            // Remove sources
-            Vertex source;
-            while (HasUnvisited(SugiyamaLayout::IsSource, vertices, source))
+        };
+        auto remove = [&](int _v)
+        {
+            unlink(_v);
+            removed[_v] = true;
+            for (const Neighbor n : adjacency.Outgoing(_v))
             {
-                for (auto& neighbor : source.outgoing_neighbors)
-                {
-                    // Add edge to new dataset
-                    new_vertices[source.idx]->outgoing_neighbors.push_back(neighbor);
-                    Neighbor rev_neighbor = neighbor;
-                    rev_neighbor.idx = source.idx;
-                    new_vertices[neighbor.idx]->incoming_neighbors.push_back(rev_neighbor);
-
-                    // Remove edge from old dataset
-                    auto& incoming = vertices[neighbor.idx]->incoming_neighbors;
-                    for (int i = 0; i < incoming.size(); i++)
-                    {
-                        if (incoming[i].edge_idx == neighbor.edge_idx)
-                        {
-                            incoming[i] = incoming[incoming.size() - 1];
-                            incoming.pop_back();
-                        }
-                    }
-                }
-                vertices[source.idx]->outgoing_neighbors.clear();
-                vertices[source.idx]->idx = VISITED_IDX;
+                if (removed[n.idx]) continue;
+                in_degree[n.idx]--;
+                place(n.idx);
             }
-
-            // Check if vertices is empty
-            size_t max_vertex_idx = VISITED_IDX;
-            int max_difference = INT_MIN;
-            for (int i = 0; i < vertices.size(); i++)
+            for (const Neighbor n : adjacency.Incoming(_v))
             {
-                if (vertices[i]->idx != VISITED_IDX)
-                {
-                    int difference = vertices[i]->outgoing_neighbors.size() - vertices[i]->incoming_neighbors.size();
-                    if (difference > max_difference)
-                    {
-                        max_vertex_idx = i;
-                        max_difference = difference;
-                    }
-                }
+                if (removed[n.idx]) continue;
+                out_degree[n.idx]--;
+                place(n.idx);
             }
+        };
 
-            // Remove max vertex with outgoing edges
-            if (max_difference > INT_MIN && max_vertex_idx != VISITED_IDX)
-            {
-                Vertex& max_vertex = *vertices[max_vertex_idx];
-                // Add outgoing to new dataset and remove from neighbors
-                for (auto& neighbor : max_vertex.outgoing_neighbors)
-                {
-                    // Add edge to new dataset
-                    new_vertices[max_vertex.idx]->outgoing_neighbors.push_back(neighbor);
-                    Neighbor rev_neighbor = neighbor;
-                    rev_neighbor.idx = max_vertex.idx;
-                    new_vertices[neighbor.idx]->incoming_neighbors.push_back(rev_neighbor);
-
-                    // Remove edge from old dataset
-                    auto& incoming = vertices[neighbor.idx]->incoming_neighbors;
-                    for (int i = 0; i < incoming.size(); i++)
-                    {
-                        if (incoming[i].edge_idx == neighbor.edge_idx)
-                        {
-                            incoming[i] = incoming[incoming.size() - 1];
-                            incoming.pop_back();
-                        }
-                    }
-                }
+        for (int v = size - 1; v >= 0; v--)
+            place(v);
 
-                // Remove incoming from neighbors
-                for (auto& neighbor : max_vertex.incoming_neighbors)
-                {
-                    // Add flipped edge to new dataset
-                    Neighbor rev_neighbor = neighbor;
-                    rev_neighbor.idx = max_vertex.idx;
-                    new_vertices[max_vertex.idx]->outgoing_neighbors.push_back(neighbor);
-                    new_vertices[neighbor.idx]->incoming_neighbors.push_back(rev_neighbor);
-                    
-                    auto& edge = new_dataset.edges[neighbor.edge_idx];
-                    VertexIdx temp = edge.to_idx;
-                    edge.to_idx = edge.from_idx;
-                    edge.from_idx = temp;
-                    _reversed_edges.push_back(edge.idx);
-
-                    // Remove edge from old dataset
-                    auto& outgoing = vertices[neighbor.idx]->outgoing_neighbors;
-                    for (int i = 0; i < outgoing.size(); i++)
-                    {
-                        if (outgoing[i].edge_idx == neighbor.edge_idx)
-                        {
-                            outgoing[i] = outgoing[outgoing.size() - 1];
-                            outgoing.pop_back();
-                        }
-                    }
-                }
-                max_vertex.outgoing_neighbors.clear();
-                max_vertex.incoming_neighbors.clear();
-                max_vertex.idx = VISITED_IDX;
+        while (true)
+        {
+            // Remove sinks and sources, their edges stay as they are
+            std::vector<int>& stack = !sinks.empty() ? sinks : sources;
+            if (!stack.empty())
+            {
+                const int v = stack.back();
+                stack.pop_back();
+                if (!removed[v]) remove(v);
+                continue;
             }
-        }
-        return new_dataset;
-    }
 
-    bool SugiyamaLayout::HasUnvisited(const std::function<bool(Vertex&)>& _f, std::vector<std::shared_ptr<Vertex>> _vs, Vertex& _out)
-    {
-        for (auto& v : _vs)
-        {
-            if (v->idx != VISITED_IDX && _f(*v))
+            // Remove the vertex with the most outgoing edges, its remaining incoming edges are reversed
+            while (max_bucket >= 0 && head[max_bucket] < 0) max_bucket--;
+            if (max_bucket < 0) break;
+            const int max_vertex_idx = head[max_bucket];
+            for (const Neighbor n : adjacency.Incoming(max_vertex_idx))
             {
-                _out = *v;
-                return true;
+                if (removed[n.idx]) continue;
+                std::swap(_graph.from[n.edge_idx], _graph.to[n.edge_idx]);
+                _graph.reversed[_graph.owner[n.edge_idx]] = true;
             }
+            remove(max_vertex_idx);
         }
-        return false;
+        _graph.BuildAdjacency();
     }
 
     //--------------------------------------------------------------
     // Layer Assignment
     //--------------------------------------------------------------
-    void SugiyamaLayout::LayerAssignment(const Dataset& _dataset, std::vector<Layer>& _vertices_per_layer, Layer& _layer_per_vertex)
+    void SugiyamaLayout::LayerAssignment(const LayeredGraph& _graph, std::vector<Layer>& _vertices_per_layer, Layer& _layer_per_vertex)
     {
-        int layer = 0;
-        Dataset copy_dataset = _dataset;
-        const int size = _dataset.vertices.size();
-        _layer_per_vertex.resize(size);
-
-        bool hasSources = false;
-        do
+        // Every layer holds the sources left after removing the layers above it
+        const auto& adjacency = _graph.adjacency;
+        const int size = _graph.vertex_count;
+        _layer_per_vertex.assign(size, 0);
+        std::vector<int> in_degree(size);
+        Layer layer;
+        for (int v = 0; v < size; v++)
         {
-            hasSources = false;
-            _vertices_per_layer.emplace_back();
-            for (auto& v : copy_dataset.vertices)
-            {
-                if (v->idx == VISITED_IDX) continue;
+            in_degree[v] = adjacency.Incoming(v).size();
+            if (in_degree[v] == 0) layer.push_back(v);
+        }
 
-                if (IsSource(*v))
-                {
-                    hasSources = true;
-                    // Assign layer to sink
-                    _layer_per_vertex[v->idx] = layer;
-                    _vertices_per_layer[layer].push_back(v->idx);
-                    v->idx = REMOVE_IDX;
-                }
-            }
-            for (auto& v : copy_dataset.vertices)
+        while (!layer.empty())
+        {
+            Layer next_layer;
+            for (const int v : layer)
             {
-                if (v->idx == REMOVE_IDX)
-                {
-                    // Remove sink from copy_dataset (including incoming edges)
-                    RemoveOutgoingNeighbors(copy_dataset, *v);
-                    v->idx = VISITED_IDX;
-                }
+                _layer_per_vertex[v] = static_cast<int>(_vertices_per_layer.size());
+                for (const Neighbor n : adjacency.Outgoing(v))
+                    if (--in_degree[n.idx] == 0) next_layer.push_back(n.idx);
             }
-            layer++;
+            std::sort(next_layer.begin(), next_layer.end());
+            _vertices_per_layer.push_back(std::move(layer));
+            layer = std::move(next_layer);
         }
-        while (hasSources);
-        _vertices_per_layer.resize(_vertices_per_layer.size() - 1);
     }
 
     //--------------------------------------------------------------
-    void SugiyamaLayout::AddDummyVertices(Dataset& _dataset, std::vector<Layer>& _vertices_per_layer,
-                                    Layer& _layer_per_vertex)
+    // Gansner, Koutsofios, North, Vo, 1993 https://doi.org/10.1109/32.221135
+    bool SugiyamaLayout::NetworkSimplexLayering(const LayeredGraph& _graph, std::vector<Layer>& _vertices_per_layer, Layer& _layer_per_vertex)
     {
-        auto& vertices = _dataset.vertices;
-        const int size = _dataset.edges.size();
-        for (int j = 0; j < size; j++)
+        // The longest path layering is a feasible start, every edge spans at least one layer
+        std::vector<Layer> longest_path;
+        LayerAssignment(_graph, longest_path, _layer_per_vertex);
+        Layer& rank = _layer_per_vertex;
+
+        const auto& adjacency = _graph.adjacency;
+        const auto& from = _graph.from;
+        const auto& to = _graph.to;
+        const int size = _graph.vertex_count;
+        const int edge_count = static_cast<int>(from.size());
+        auto slack = [&](int _e) { return rank[to[_e]] - rank[from[_e]] - 1; };
+        auto other = [&](int _e, int _v) { return from[_e] == _v ? to[_e] : from[_e]; };
+        // Self loops are not in the adjacency, so every incident edge has another end
+        auto for_each_incident = [&](int _v, auto&& _f)
         {
-            int current_edge_idx = j;
-            const auto& edge = _dataset.edges[current_edge_idx];
-            const int start_layer = _layer_per_vertex[edge.from_idx];
-            const int end_layer = _layer_per_vertex[edge.to_idx];
-            if (end_layer - start_layer <= 1) continue;
+            for (const Neighbor n : adjacency.Outgoing(_v)) _f(n.edge_idx);
+            for (const Neighbor n : adjacency.Incoming(_v)) _f(n.edge_idx);
+        };
 
-            for (int i = start_layer; i < end_layer - 1; i++)
+        // Step 01: Feasible tree, a spanning tree of tight edges per weakly connected component
+        std::vector<bool> tree_edge(edge_count, false), in_tree(size, false);
+        std::vector<int> roots, component(size, -1);
+        {
+            std::vector<int> members, queue;
+            for (int root = 0; root < size; root++)
             {
-                auto& e = _dataset.edges[current_edge_idx];
-                RemoveNeighbors(_dataset, e);
-
-                vertices.emplace_back(std::make_shared<Vertex>());
-                Vertex& dummy_vertex = *vertices.back();
-                dummy_vertex.id = DUMMY_ID;
-                dummy_vertex.idx = _dataset.vertices.size() - 1;
-                
-                _layer_per_vertex.emplace_back(i + 1);
-                _vertices_per_layer[i + 1].emplace_back(dummy_vertex.idx);
-
-                Edge dummy_edge;
-                dummy_edge.from_idx = dummy_vertex.idx;
-                dummy_edge.to_idx = e.to_idx;
-                dummy_edge.idx = _dataset.edges.size();
-                e.to_idx = dummy_vertex.idx;
+                if (component[root] >= 0) continue;
+                members.assign(1, root);
+                component[root] = static_cast<int>(roots.size());
+                for (size_t i = 0; i < members.size(); i++)
+                {
+                    for_each_incident(members[i], [&](int _e)
+                    {
+                        const int w = other(_e, members[i]);
+                        if (component[w] < 0)
+                        {
+                            component[w] = component[root];
+                            members.push_back(w);
+                        }
+                    });
+                }
+                roots.push_back(root);
 
-                AddNeighbors(_dataset, e);
-                AddNeighbors(_dataset, dummy_edge);
+                std::vector<int> tree(1, root);
+                in_tree[root] = true;
+                queue.assign(1, root);
+                while (true)
+                {
+                    // Grow the tree along tight edges
+                    while (!queue.empty())
+                    {
+                        const int v = queue.back();
+                        queue.pop_back();
+                        for_each_incident(v, [&](int _e)
+                        {
+                            const int w = other(_e, v);
+                            if (in_tree[w] || slack(_e) != 0) return;
+                            in_tree[w] = true;
+                            tree_edge[_e] = true;
+                            tree.push_back(w);
+                            queue.push_back(w);
+                        });
+                    }
+                    if (tree.size() == members.size()) break;
 
-                current_edge_idx = dummy_edge.idx;
-                _dataset.edges.emplace_back(dummy_edge);
+                    // Move the tree towards the vertex with the least slack, that edge becomes tight
+                    int min_edge = -1;
+                    for (const int v : tree)
+                    {
+                        for_each_incident(v, [&](int _e)
+                        {
+                            if (!in_tree[other(_e, v)] && (min_edge < 0 || slack(_e) < slack(min_edge))) min_edge = _e;
+                        });
+                    }
+                    const int delta = in_tree[to[min_edge]] ? -slack(min_edge) : slack(min_edge);
+                    for (const int v : tree)
+                        rank[v] += delta;
+                    queue.push_back(in_tree[to[min_edge]] ? to[min_edge] : from[min_edge]);
+                }
             }
         }
-    }
 
-    bool SugiyamaLayout::IsSink(const Vertex& _v)
-    {
-        return _v.outgoing_neighbors.empty();
-    }
-
-    bool SugiyamaLayout::IsSource(const Vertex& _v)
-    {
-        return _v.incoming_neighbors.empty();
-    }
-
-    void SugiyamaLayout::RemoveOutgoingNeighbors(Dataset& _dataset, Vertex& _v)
-    {
-        // Add outgoing to new dataset and remove from neighbors
-        for (const auto& neighbor : _v.outgoing_neighbors)
+        // Step 02: Postorder ranges and cut values of the tree edges, the cut value is the weight of the
+        // edges from the tail component to the head component minus the weight of those going back
+        std::vector<int> low(size), lim(size), parent_edge(size), postorder(size), cut_value(edge_count, 0);
+        // Numbers the subtree of the tree edges below _root from _counter on, the rest of the tree keeps its numbers
+        std::vector<std::pair<int, int>> stack;
+        auto dfs_range = [&](int _root, int _counter)
         {
-            // Remove edge from dataset
-            auto& incoming = _dataset.vertices[neighbor.idx]->incoming_neighbors;
-            for (size_t i = 0; i < incoming.size(); i++)
+            low[_root] = _counter;
+            stack.emplace_back(_root, 0);
+            while (!stack.empty())
             {
-                if (incoming[i].edge_idx == neighbor.edge_idx)
+                auto& [v, i] = stack.back();
+                const auto outgoing = adjacency.Outgoing(v);
+                const auto incoming = adjacency.Incoming(v);
+                if (i < outgoing.size() + incoming.size())
                 {
-                    incoming[i] = incoming[incoming.size() - 1];
-                    incoming.pop_back();
+                    const int e = i < outgoing.size() ? outgoing[i].edge_idx : incoming[i - outgoing.size()].edge_idx;
+                    i++;
+                    if (!tree_edge[e] || e == parent_edge[v]) continue;
+                    const int w = other(e, v);
+                    parent_edge[w] = e;
+                    low[w] = _counter;
+                    stack.emplace_back(w, 0);
+                    continue;
                 }
+                postorder[_counter] = v;
+                lim[v] = _counter++;
+                stack.pop_back();
             }
-        }
-        _v.outgoing_neighbors.clear();
-    }
-
-    void SugiyamaLayout::RemoveNeighbors(Dataset& _dataset, const Edge& _e)
-    {
-        auto& outgoing = _dataset.vertices[_e.from_idx]->outgoing_neighbors;
-        for (size_t i = 0; i < outgoing.size(); i++)
+            return _counter;
+        };
         {
-            if (outgoing[i].idx == _e.to_idx)
+            int counter = 0;
+            for (const int root : roots)
             {
-                outgoing[i] = outgoing[outgoing.size() - 1];
-                outgoing.pop_back();
-                break;
+                parent_edge[root] = -1;
+                counter = dfs_range(root, counter);
+            }
+
+            // Children before parents, the cut value of a tree edge follows from those below it
+            for (const int v : postorder)
+            {
+                const int f = parent_edge[v];
+                if (f < 0) continue;
+                const bool v_is_tail = from[f] == v;
+                int sum = 0;
+                for_each_incident(v, [&](int _e)
+                {
+                    const int w = other(_e, v);
+                    const bool outside = lim[w] < low[v] || lim[w] > lim[v];
+                    int value = outside ? 1 : (tree_edge[_e] ? cut_value[_e] : 0) - 1;
+                    bool positive = v_is_tail ? to[_e] == v : from[_e] == v;
+                    if (outside) positive = !positive;
+                    sum += positive ? value : -value;
+                });
+                cut_value[f] = sum;
             }
         }
 
-        auto& incoming = _dataset.vertices[_e.to_idx]->incoming_neighbors;
-        for (size_t i = 0; i < incoming.size(); i++)
+        // Step 03: Exchange a tree edge with a negative cut value for the tightest edge that reconnects the tree.
+        // Only the tree path the entering edge closes changes its cut values, and only the subtree above it its
+        // numbers, so a pivot costs the size of the cut off subtree instead of the whole graph
+        auto in_subtree = [&](int _v, int _root) { return low[_root] <= lim[_v] && lim[_v] <= lim[_root]; };
+        // Adds the cut value of the leaving edge along the path from _v up to the first vertex above _w
+        auto update_path = [&](int _v, int _w, int _value, bool _tail_side)
+        {
+            while (!in_subtree(_w, _v))
+            {
+                const int e = parent_edge[_v];
+                cut_value[e] += (_v == from[e]) == _tail_side ? _value : -_value;
+                _v = other(e, _v);
+            }
+            return _v;
+        };
+        const int max_iterations = std::max(100, 10 * size);
+        int search_start = 0;
+        bool optimal = false;
+        for (int iteration = 0; iteration < max_iterations; iteration++)
         {
-            if (incoming[i].idx == _e.from_idx)
+            int leave = -1;
+            for (int i = 0; i < edge_count && leave < 0; i++)
+            {
+                const int e = (search_start + i) % edge_count;
+                if (tree_edge[e] && cut_value[e] < 0) leave = e;
+            }
+            if (leave < 0)
             {
-                incoming[i] = incoming[incoming.size() - 1];
-                incoming.pop_back();
+                optimal = true;
                 break;
             }
+            search_start = leave;
+
+            // The subtree below the leaving edge is one side of the cut, the entering edge goes from the
+            // head component to the tail component of the leaving edge
+            const int below = lim[from[leave]] < lim[to[leave]] ? from[leave] : to[leave];
+            const bool below_is_tail = below == from[leave];
+            int enter = -1;
+            for (int i = low[below]; i <= lim[below]; i++)
+            {
+                const int v = postorder[i];
+                for_each_incident(v, [&](int _e)
+                {
+                    if (tree_edge[_e] || in_subtree(other(_e, v), below)) return;
+                    if ((v == to[_e]) != below_is_tail) return;
+                    if (enter < 0 || slack(_e) < slack(enter)) enter = _e;
+                });
+            }
+            if (enter < 0) break;
+
+            // Move the subtree so the entering edge becomes tight, the edges across the cut stay feasible
+            const int delta = below_is_tail ? -slack(enter) : slack(enter);
+            for (int i = low[below]; i <= lim[below]; i++)
+                rank[postorder[i]] += delta;
+
+            const int value = cut_value[leave];
+            const int lca = update_path(from[enter], to[enter], value, true);
+            update_path(to[enter], from[enter], value, false);
+            cut_value[enter] = -value;
+            cut_value[leave] = 0;
+            tree_edge[leave] = false;
+            tree_edge[enter] = true;
+            dfs_range(lca, low[lca]);
         }
-    }
 
-    void SugiyamaLayout::AddNeighbors(const Dataset& _dataset, Edge& _e)
-    {
-        auto& outgoing = _dataset.vertices[_e.from_idx]->outgoing_neighbors;
-        outgoing.emplace_back(_e.to_idx, _e.idx);
-        auto& incoming = _dataset.vertices[_e.to_idx]->incoming_neighbors;
-        incoming.emplace_back(_e.from_idx, _e.idx);
+        // Step 04: Every component starts at the top layer
+        std::vector<int> min_rank(roots.size(), INT_MAX);
+        for (int v = 0; v < size; v++)
+            min_rank[component[v]] = std::min(min_rank[component[v]], rank[v]);
+        int layer_count = 0;
+        for (int v = 0; v < size; v++)
+        {
+            rank[v] -= min_rank[component[v]];
+            layer_count = std::max(layer_count, rank[v] + 1);
+        }
+        _vertices_per_layer.assign(layer_count, {});
+        for (int v = 0; v < size; v++)
+            _vertices_per_layer[rank[v]].push_back(v);
+        return optimal;
     }
 
-    void SugiyamaLayout::RemoveIncomingNeighbors(const Dataset& _dataset, Vertex& _v)
+    //--------------------------------------------------------------
+    void SugiyamaLayout::AddDummyVertices(LayeredGraph& _graph, std::vector<Layer>& _vertices_per_layer,
+                                    Layer& _layer_per_vertex)
     {
-        // Remove incoming from neighbors
-        for (const auto& neighbor : _v.incoming_neighbors)
+        const int size = static_cast<int>(_graph.from.size());
+        for (int j = 0; j < size; j++)
         {
-            // Remove edge from old dataset
-            auto& outgoing = _dataset.vertices[neighbor.idx]->outgoing_neighbors;
-            for (int i = 0; i < outgoing.size(); i++)
+            const int start_layer = _layer_per_vertex[_graph.from[j]];
+            const int end_layer = _layer_per_vertex[_graph.to[j]];
+            if (end_layer - start_layer <= 1) continue;
+
+            // Split the edge into an edge per layer it spans
+            int current_edge_idx = j;
+            for (int i = start_layer; i < end_layer - 1; i++)
             {
-                if (outgoing[i].edge_idx == neighbor.edge_idx)
-                {
-                    outgoing[i] = outgoing[outgoing.size() - 1];
-                    outgoing.pop_back();
-                }
+                const int dummy_idx = _graph.vertex_count++;
+                _layer_per_vertex.emplace_back(i + 1);
+                _vertices_per_layer[i + 1].emplace_back(dummy_idx);
+
+                const VertexIdx to_idx = _graph.to[current_edge_idx];
+                _graph.to[current_edge_idx] = dummy_idx;
+                _graph.from.push_back(dummy_idx);
+                _graph.to.push_back(to_idx);
+                _graph.owner.push_back(_graph.owner[j]);
+                current_edge_idx = static_cast<int>(_graph.from.size()) - 1;
             }
         }
-        _v.incoming_neighbors.clear();
+        _graph.BuildAdjacency();
     }
 
     //--------------------------------------------------------------
     // Crossing Minimization
     //--------------------------------------------------------------
-    int SugiyamaLayout::CrossingMinimization(Dataset& _dataset, std::vector<Layer>& _vertices_per_layer,
-                                       const OSCMHeuristic& _heuristic, int _iterations)
+    int SugiyamaLayout::CrossingMinimization(const LayeredGraph& _graph, std::vector<Layer>& _vertices_per_layer,
+                                       const OSCMHeuristic& _heuristic, int _iterations, LayoutJob::Progress& _progress,
+                                       uint _seed, bool _parallel, uint* _winning_seed)
     {
-        auto& vertices = _dataset.vertices;
-        const GetNeighbors get_neighbors = [](Vertex& v) { return v.outgoing_neighbors; };
-        const GetNeighbors get_reverse_neighbors = [](Vertex& v) { return v.incoming_neighbors; };
+        const Adjacency& adjacency = _graph.adjacency;
+        const GetNeighbors get_neighbors = [&](VertexIdx v) { return adjacency.Outgoing(v); };
+        const GetNeighbors get_reverse_neighbors = [&](VertexIdx v) { return adjacency.Incoming(v); };
 
+        std::mutex best_mutex;
         int best_crossings = INT_MAX;
+        int best_restart = -1;
         std::vector<Layer> best;
-        for (int i = 0; i < _iterations; i++)
+        std::atomic<int> restarts_done = 0;
+        auto restart = [&](int i)
         {
-            // Copy and shuffle first layer
+            if (_progress.Cancelled()) return;
+
+            // Copy and shuffle every layer, the sweeps keep the order of vertices with the same barycenter
+            // and a first layer of a single source would start every restart the same
             std::vector<Layer> vertices_per_layer = _vertices_per_layer;
-            std::shuffle(vertices_per_layer[0].begin(), vertices_per_layer[0].end(), Random::random_device);
+            std::mt19937 rng(_seed + static_cast<uint>(i));
+            for (Layer& layer : vertices_per_layer)
+                std::shuffle(layer.begin(), layer.end(), rng);
             int crossings = 0;
             int new_crossings = INT_MAX;
 
@@ -561,8 +728,7 @@ namespace DataVis
                 for (size_t j = 1; j < vertices_per_layer.size(); j++)
                 {
                     Layer new_layer;
-                    _heuristic(_dataset, vertices_per_layer[j - 1], vertices_per_layer[j], new_layer,
-                               get_reverse_neighbors);
+                    _heuristic(vertices_per_layer[j - 1], vertices_per_layer[j], new_layer, get_reverse_neighbors);
                     vertices_per_layer[j] = new_layer;
                 }
 
@@ -570,35 +736,47 @@ namespace DataVis
                 for (int j = vertices_per_layer.size() - 2; j >= 0; j--)
                 {
                     Layer new_layer;
-                    _heuristic(_dataset, vertices_per_layer[j + 1], vertices_per_layer[j], new_layer, get_neighbors);
+                    _heuristic(vertices_per_layer[j + 1], vertices_per_layer[j], new_layer, get_neighbors);
                     vertices_per_layer[j] = new_layer;
                 }
 
                 // Count crossings
                 for (int j = 1; j < vertices_per_layer.size(); j++)
                 {
-                    new_crossings += Crossings(_dataset, vertices_per_layer[j - 1], vertices_per_layer[j]);
+                    new_crossings += Crossings(adjacency, vertices_per_layer[j - 1], vertices_per_layer[j]);
                 }
             }
             while (new_crossings < crossings);
 
-            if (new_crossings < best_crossings)
             {
-                // Found a better permutation for each layer
-                best_crossings = new_crossings;
-                best = vertices_per_layer;
+                // Found a better permutation for each layer, the order of the restarts decides ties
+                std::lock_guard<std::mutex> lock(best_mutex);
+                if (new_crossings < best_crossings || (new_crossings == best_crossings && i < best_restart))
+                {
+                    best_crossings = new_crossings;
+                    best_restart = i;
+                    best = std::move(vertices_per_layer);
+                }
             }
-        }
+            // The restarts take most of the time of the framework
+            _progress.Set(.2f + .7f * static_cast<float>(++restarts_done) / static_cast<float>(_iterations));
+        };
+
+        if (_parallel)
+            ThreadPool::Global().ParallelFor(0, _iterations, restart);
+        else
+            for (int i = 0; i < _iterations; i++) restart(i);
 
-        _vertices_per_layer = best;
+        if (!best.empty())
+            _vertices_per_layer = std::move(best);
+        if (_winning_seed && best_restart >= 0)
+            *_winning_seed = _seed + static_cast<uint>(best_restart);
         return best_crossings;
     }
 
-    bool SugiyamaLayout::OSCMBarycenterHeuristic(const Dataset& _dataset, const Layer& _layer_fixed, Layer& _layer, Layer& _new_layer,
+    bool SugiyamaLayout::OSCMBarycenterHeuristic(const Layer& _layer_fixed, Layer& _layer, Layer& _new_layer,
                                                  const GetNeighbors& _get_neighbors)
     {
-        auto& vertices = _dataset.vertices;
-
         std::unordered_map<int, int> pos_per_vertex;
         for (size_t i = 0; i < _layer_fixed.size(); i++)
         {
@@ -610,8 +788,8 @@ namespace DataVis
         for (int i = 0; i < _layer.size(); i++)
         {
             float coor = 0;
-            auto& neighbors = _get_neighbors(*vertices[_layer[i]]);
-            for (auto& neighbor : neighbors)
+            const auto neighbors = _get_neighbors(_layer[i]);
+            for (const Neighbor neighbor : neighbors)
                 coor += pos_per_vertex[neighbor.idx];
             coor /= static_cast<float>(neighbors.size());
             coords[i] = {coor, _layer[i]};
@@ -630,14 +808,11 @@ namespace DataVis
     }
 
     bool SugiyamaLayout::OSCMMedianHeuristic(
-        const Dataset& _dataset,
         const Layer& _layer_fixed,
         Layer& _layer,
         Layer& _new_layer,
         const GetNeighbors& _get_neighbors )
     {
-        auto& vertices = _dataset.vertices;
-
         std::unordered_map<int, int> pos_per_vertex;
         for (int i = 0; i < _layer_fixed.size(); i++)
         {
@@ -648,7 +823,7 @@ namespace DataVis
         std::vector<std::tuple<int, int, int, int>> medians( _layer.size() );
         for (int i = 0; i < _layer.size(); i++)
         {
-            auto& neighbors = _get_neighbors( *vertices[_layer[i]] );
+            const auto neighbors = _get_neighbors( _layer[i] );
             int degree = neighbors.size();
             if (degree == 0)
             {
@@ -699,248 +874,305 @@ namespace DataVis
         return changed;
     }
 
-    int SugiyamaLayout::Crossings(const Dataset& _dataset, const Layer& _layer_1, const Layer& _layer_2)
+    // Barth, Juenger, Mutzel, 2004 https://doi.org/10.7155/jgaa.00088
+    int SugiyamaLayout::Crossings(const Adjacency& _adjacency, const Layer& _layer_1, const Layer& _layer_2)
     {
-        std::vector<bool> flags;
-        std::vector<std::pair<int, int>> open_edges;
-        int count = 0;
-        // First open all edges
-        for (int i = 0; i < _layer_1.size(); i++)
+        // Position of every vertex in layer 2, reset before returning so the buffer can be reused
+        thread_local std::vector<int> position;
+        position.resize(std::max(position.size(), _adjacency.Size()), -1);
+        for (int i = 0; i < _layer_2.size(); i++)
+            position[_layer_2[i]] = i;
+
+        // Accumulator tree with a leaf per position in layer 2
+        int first_leaf = 1;
+        while (first_leaf < _layer_2.size()) first_leaf *= 2;
+        const int tree_size = 2 * first_leaf - 1;
+        first_leaf -= 1;
+        std::vector<int> tree(tree_size, 0);
+
+        // Insert the edges ordered by their source in layer 1, then by their target in layer 2.
+        // Every entry already in the tree with a greater target position is an edge that crosses.
+        long long count = 0;
+        std::vector<int> targets;
+        for (const int vertex_idx : _layer_1)
         {
-            int vertex_idx = _layer_1[i];
-            auto& neighbors = _dataset.vertices[vertex_idx]->outgoing_neighbors;
-
-            for (auto& n : neighbors)
-                open_edges.emplace_back(vertex_idx, n.idx);
-        }
-        flags.resize(open_edges.size(), false);
+            targets.clear();
+            for (const Neighbor n : _adjacency.Outgoing(vertex_idx))
+                if (position[n.idx] >= 0) targets.push_back(position[n.idx]);
+            std::sort(targets.begin(), targets.end());
 
-        // Then close all edges
-        for (int i = _layer_2.size() - 1; i >= 0; i--)
-        {
-            int vertex_idx = _layer_2[i];
-            auto& neighbors = _dataset.vertices[vertex_idx]->incoming_neighbors;
-            for (auto& n : neighbors)
+            for (const int target : targets)
             {
-                std::pair<int, int> edge(n.idx, vertex_idx);
-                // Backwards linear scan
-                for (int j = open_edges.size() - 1; j >= 0; j--)
+                int index = target + first_leaf;
+                tree[index]++;
+                while (index > 0)
                 {
-                    if (flags[j]) continue;
-                    // Encountered ourselves
-                    if (open_edges[j] == edge)
-                    {
-                        // Remove ourself from open_edges
-                        flags[j] = true;
-                        break;
-                    }
-
-                    if (open_edges[j].first != edge.first && open_edges[j].second != edge.second)
-                    {
-                        // Found a crossing
-                        count++;
-                    }
+                    if (index % 2) count += tree[index + 1];
+                    index = (index - 1) / 2;
+                    tree[index]++;
                 }
             }
         }
 
-        return count;
+        for (const int vertex_idx : _layer_2)
+            position[vertex_idx] = -1;
+        return static_cast<int>(count);
     }
 
     //--------------------------------------------------------------
     // Vertex Positioning
     //--------------------------------------------------------------
+    // Brandes, Koepf, 2001 https://doi.org/10.1007/3-540-45848-4_3
     std::vector<float> SugiyamaLayout::VertexPositioning(
-        const Dataset& _dataset,
+        const LayeredGraph& _graph,
         const std::vector<Layer>& _vertices_per_layer,
-        Layer& _layer_per_vertex,
         float _delta)
     {
-        const auto& vertices = _dataset.vertices;
-        std::vector<int> pos_per_vertex(vertices.size());
-        for (auto& layer : _vertices_per_layer)
+        const int size = _graph.vertex_count;
+        FlatLayers layers;
+        layers.Init(_graph, _vertices_per_layer);
+        std::vector<bool> conflicted_edges;
+        FlagType1Conflicts(_graph, layers, conflicted_edges);
+
+        // The four alignments only share what they read, 0 and 1 sweep downwards, 0 and 2 from the left
+        std::vector<float> x_per_direction[4];
+        ThreadPool::Global().ParallelFor(0, 4, [&](int _direction)
         {
-            for (int i = 0; i < layer.size(); i++)
-            {
-                pos_per_vertex[layer[i]] = i;
-            }
+            const bool downwards = _direction < 2;
+            const bool from_left = _direction % 2 == 0;
+            std::vector<int> root;
+            VerticalAlignment(layers, conflicted_edges, downwards, from_left, root);
+            HorizontalCompaction(layers, root, from_left, _delta, x_per_direction[_direction]);
+        });
+
+        // Align the others to the narrowest alignment, the left ones on its left side, the right ones on its right side
+        float min_x[4], max_x[4];
+        int narrowest = 0;
+        for (int d = 0; d < 4; d++)
+        {
+            const auto [min, max] = std::minmax_element(x_per_direction[d].begin(), x_per_direction[d].end());
+            min_x[d] = size > 0 ? *min : 0;
+            max_x[d] = size > 0 ? *max : 0;
+            if (max_x[d] - min_x[d] < max_x[narrowest] - min_x[narrowest]) narrowest = d;
+        }
+        for (int d = 0; d < 4; d++)
+        {
+            const float shift = d % 2 == 0 ? min_x[narrowest] - min_x[d] : max_x[narrowest] - max_x[d];
+            for (float& x : x_per_direction[d])
+                x += shift;
         }
 
-        std::vector<std::pair<int, int>> flags;
-        std::vector<int> root, align;
-        std::vector<float> x_per_vertex;
+        // Balance, the average of the two median coordinates
+        std::vector<float> x_per_vertex(size);
+        float min_balanced = MAX_FLOAT;
+        for (int v = 0; v < size; v++)
+        {
+            float xs[4] = { x_per_direction[0][v], x_per_direction[1][v], x_per_direction[2][v], x_per_direction[3][v] };
+            std::sort(std::begin(xs), std::end(xs));
+            x_per_vertex[v] = (xs[1] + xs[2]) * .5f;
+            min_balanced = std::min(min_balanced, x_per_vertex[v]);
+        }
+        for (float& x : x_per_vertex)
+            x -= min_balanced;
+        return x_per_vertex;
+    }
 
-        //FlagType1Conflicts( _dataset, _vertices_per_layer, _layer_per_vertex, flags );
-        VerticalAlignment(_dataset, _vertices_per_layer, _layer_per_vertex, pos_per_vertex, root, align, flags);
-        HorizontalCompaction(_dataset, _vertices_per_layer, _layer_per_vertex, pos_per_vertex, root, align,
-                             x_per_vertex, _delta);
+    void SugiyamaLayout::FlatLayers::Init(const LayeredGraph& _graph, const std::vector<Layer>& _vertices_per_layer)
+    {
+        const int size = _graph.vertex_count;
+        layer_offsets.assign(1, 0);
+        layer_vertices.clear();
+        layer_vertices.reserve(size);
+        layer_per_vertex.assign(size, 0);
+        pos_per_vertex.assign(size, 0);
+        for (size_t i = 0; i < _vertices_per_layer.size(); i++)
+        {
+            const Layer& layer = _vertices_per_layer[i];
+            for (size_t k = 0; k < layer.size(); k++)
+            {
+                layer_per_vertex[layer[k]] = static_cast<int>(i);
+                pos_per_vertex[layer[k]] = static_cast<int>(k);
+            }
+            layer_vertices.insert(layer_vertices.end(), layer.begin(), layer.end());
+            layer_offsets.push_back(static_cast<int>(layer_vertices.size()));
+        }
 
-        return x_per_vertex;
+        // Every edge connects two neighboring layers, the edges go down
+        for (int side = 0; side < 2; side++)
+        {
+            auto& offsets = neighbor_offsets[side];
+            auto& sorted = neighbors[side];
+            offsets.assign(size + 1, 0);
+            sorted.clear();
+            sorted.reserve(_graph.adjacency.Size());
+            for (int v = 0; v < size; v++)
+            {
+                const auto adjacent = side == 0 ? _graph.adjacency.Incoming(v) : _graph.adjacency.Outgoing(v);
+                const auto begin = sorted.end() - sorted.begin();
+                sorted.insert(sorted.end(), adjacent.begin(), adjacent.end());
+                std::sort(sorted.begin() + begin, sorted.end(), [&](Neighbor _lhs, Neighbor _rhs)
+                {
+                    return pos_per_vertex[_lhs.idx] < pos_per_vertex[_rhs.idx];
+                });
+                offsets[v + 1] = static_cast<int>(sorted.size());
+            }
+        }
     }
 
-    void SugiyamaLayout::FlagType1Conflicts(
-        const Dataset& _dataset,
-        const std::vector<Layer>& _vertices_per_layer,
-        Layer& _layer_per_vertex,
-        std::vector<std::pair<int, int>>& _flags)
+    void SugiyamaLayout::FlagType1Conflicts(const LayeredGraph& _graph, const FlatLayers& _layers, std::vector<bool>& _conflicted_edges)
     {
-        auto& vertices = _dataset.vertices;
-        for (int i = 1; i < _vertices_per_layer.size() - 1; i++)
+        const auto& pos = _layers.pos_per_vertex;
+        const auto& offsets = _layers.neighbor_offsets[0];
+        const auto& above = _layers.neighbors[0];
+        _conflicted_edges.assign(_graph.from.size(), false);
+
+        const int layer_count = static_cast<int>(_layers.layer_offsets.size()) - 1;
+        for (int i = 1; i < layer_count; i++)
         {
+            const int begin = _layers.layer_offsets[i], end = _layers.layer_offsets[i + 1];
+            // The inner segments seen so far end between k_0 and k_1 on the layer above
             int k_0 = 0;
-            int l = 1;
-
-            for (int l_1 = 0; l_1 < _vertices_per_layer[i + 1].size(); l_1++)
+            int scan = begin;
+            for (int l = begin; l < end; l++)
             {
-                int vertex_id = _vertices_per_layer[i + 1][l_1];
-                if (l_1 == _vertices_per_layer[i + 1].size() - 1);
+                const VertexIdx v = _layers.layer_vertices[l];
+                // A dummy vertex has one neighbor above, when it is a dummy vertex too their edge is an inner segment
+                const bool inner = _graph.IsDummy(v) && offsets[v + 1] > offsets[v] && _graph.IsDummy(above[offsets[v]].idx);
+                if (!inner && l != end - 1) continue;
+
+                const int k_1 = inner ? pos[above[offsets[v]].idx] : _layers.LayerSize(i - 1) - 1;
+                for (; scan <= l; scan++)
+                {
+                    const VertexIdx w = _layers.layer_vertices[scan];
+                    for (int n = offsets[w]; n < offsets[w + 1]; n++)
+                    {
+                        const VertexIdx u = above[n].idx;
+                        if ((pos[u] < k_0 || pos[u] > k_1) && !(_graph.IsDummy(u) && _graph.IsDummy(w)))
+                            _conflicted_edges[above[n].edge_idx] = true;
+                    }
+                }
+                k_0 = k_1;
             }
         }
     }
 
     void SugiyamaLayout::VerticalAlignment(
-        const Dataset& _dataset,
-        const std::vector<Layer>& _vertices_per_layer,
-        Layer& _layer_per_vertex,
-        const Layer& _pos_per_vertex,
-        std::vector<int>& _root,
-        std::vector<int>& _align,
-        std::vector<std::pair<int, int>>& _flags)
+        const FlatLayers& _layers,
+        const std::vector<bool>& _conflicted_edges,
+        bool _downwards,
+        bool _from_left,
+        std::vector<int>& _root)
     {
-        const auto& vertices = _dataset.vertices;
-        _root.resize(vertices.size());
-        _align.resize(vertices.size());
-        for (int i = 0; i < vertices.size(); i++)
+        const int size = static_cast<int>(_layers.pos_per_vertex.size());
+        const int layer_count = static_cast<int>(_layers.layer_offsets.size()) - 1;
+        // The neighbors on the layer the sweep comes from, in the order the sweep sees them
+        const auto& offsets = _layers.neighbor_offsets[_downwards ? 0 : 1];
+        const auto& neighbors = _layers.neighbors[_downwards ? 0 : 1];
+        auto pos = [&](VertexIdx _v)
+        {
+            const int p = _layers.pos_per_vertex[_v];
+            return _from_left ? p : _layers.LayerSize(_layers.layer_per_vertex[_v]) - 1 - p;
+        };
+
+        std::vector<int> align(size);
+        _root.resize(size);
+        for (int v = 0; v < size; v++)
         {
-            _root[i] = i;
-            _align[i] = i;
+            _root[v] = v;
+            align[v] = v;
         }
 
-        for (size_t i = 0; i < _vertices_per_layer.size(); i++)
+        for (int li = 0; li < layer_count; li++)
         {
-            int rank = -1;
-            auto& current_layer = _vertices_per_layer[i];
-            for (size_t k = 0; k < current_layer.size(); k++)
+            const int i = _downwards ? li : layer_count - 1 - li;
+            const int begin = _layers.layer_offsets[i];
+            const int layer_size = _layers.LayerSize(i);
+            int r = -1;
+            for (int k = 0; k < layer_size; k++)
             {
-                int vertex_idx = current_layer[k];
-                int d = vertices[vertex_idx]->outgoing_neighbors.size();
-                if (d <= 0) continue;
-                int ms[2] = {
-                    static_cast<int>(std::floorf((d + 1) * 0.5)),
-                    static_cast<int>(std::ceilf((d + 1) * 0.5))
-                };
-
-                // Sort neighbors on horizontal position
-                auto& neighbors = vertices[vertex_idx]->outgoing_neighbors;
-                std::sort(neighbors.begin(), neighbors.end(), [&](Neighbor lhs, Neighbor rhs)
-                {
-                    return _pos_per_vertex[lhs.idx] < _pos_per_vertex[rhs.idx];
-                });
+                const VertexIdx v = _layers.layer_vertices[begin + (_from_left ? k : layer_size - 1 - k)];
+                const int degree = offsets[v + 1] - offsets[v];
+                if (degree == 0) continue;
 
-                for (int m : ms)
+                // The lower and the upper median, one and the same for an odd degree
+                for (int m = (degree - 1) / 2; m <= degree / 2; m++)
                 {
-                    int u_m = vertices[vertex_idx]->outgoing_neighbors[m - 1].idx;
-
-                    if (_align[vertex_idx] != vertex_idx) continue;
-                    // If not flagged
-                    if (std::find(_flags.begin(), _flags.end(), std::pair<int, int>(u_m, vertex_idx)) != _flags.end())
-                        continue;
-                    if (rank >= _pos_per_vertex[u_m]) continue;
-
-                    _align[u_m] = vertex_idx;
-                    _root[vertex_idx] = _root[u_m];
-                    _align[vertex_idx] = _root[vertex_idx];
-                    rank = _pos_per_vertex[u_m];
+                    const Neighbor median = neighbors[offsets[v] + (_from_left ? m : degree - 1 - m)];
+                    if (align[v] != v) break;
+                    if (_conflicted_edges[median.edge_idx] || r >= pos(median.idx)) continue;
+                    align[median.idx] = v;
+                    _root[v] = _root[median.idx];
+                    align[v] = _root[v];
+                    r = pos(median.idx);
                 }
             }
         }
     }
 
     void SugiyamaLayout::HorizontalCompaction(
-        const Dataset& _dataset,
-        const std::vector<Layer>& _vertices_per_layer,
-        const Layer& _layer_per_vertex,
-        const Layer& _pos_per_vertex,
+        const FlatLayers& _layers,
         const std::vector<int>& _root,
-        const std::vector<int>& _align,
-        std::vector<float>& _x_per_vertex,
-        float _delta)
+        bool _from_left,
+        float _delta,
+        std::vector<float>& _x_per_vertex)
     {
-        constexpr float undefined = MIN_FLOAT;
-        constexpr float infinite = MAX_FLOAT;
-        const auto& vertices = _dataset.vertices;
-        std::vector<float> sink(vertices.size());
-        for (int i = 0; i < vertices.size(); i++)
-            sink[i] = i;
-        std::vector<float> shift(vertices.size(), infinite);
-        _x_per_vertex.resize(vertices.size(), undefined);
-
-        std::function<void(int)> place_block = [&](int v)
-        {
-            if (_x_per_vertex[v] != undefined) return;
-            _x_per_vertex[v] = 0;
-            int w = v;
-            do
+        // The blocks in a graph with an edge from every block to the block right of it on some layer,
+        // so the placement is a longest path instead of the recursion of the paper
+        const int size = static_cast<int>(_root.size());
+        const int layer_count = static_cast<int>(_layers.layer_offsets.size()) - 1;
+        std::vector<int> block_offsets(size + 1, 0), block_edges;
+        auto for_each_pair = [&](auto&& _f)
+        {
+            for (int i = 0; i < layer_count; i++)
             {
-                const int w_pos = _pos_per_vertex[w];
-                if (w_pos > 0)
+                const int begin = _layers.layer_offsets[i], end = _layers.layer_offsets[i + 1];
+                for (int l = begin + 1; l < end; l++)
                 {
-                    const int layer = _layer_per_vertex[w];
-                    const int pred_w = _vertices_per_layer[layer][w_pos - 1];
-                    int u = _root[pred_w];
-                    place_block(u);
-                    if (sink[v] == v) sink[v] = sink[u];
-                    if (sink[v] == sink[u])
-                        _x_per_vertex[v] = std::max(_x_per_vertex[v], _x_per_vertex[u] + _delta);
+                    const VertexIdx left = _layers.layer_vertices[l - 1], right = _layers.layer_vertices[l];
+                    if (_from_left) _f(_root[left], _root[right]);
+                    else _f(_root[right], _root[left]);
                 }
-                w = _align[w];
-            }
-            while (w != v);
-
-            while (_align[w] != v)
-            {
-                w = _align[w];
-                _x_per_vertex[w] = _x_per_vertex[v];
-                sink[w] = sink[v];
             }
         };
+        for_each_pair([&](int _from, int) { block_offsets[_from + 1]++; });
+        std::partial_sum(block_offsets.begin(), block_offsets.end(), block_offsets.begin());
+        block_edges.resize(block_offsets[size]);
+        std::vector<int> in_degree(size, 0), fill(block_offsets.begin(), block_offsets.end() - 1);
+        for_each_pair([&](int _from, int _to)
+        {
+            block_edges[fill[_from]++] = _to;
+            in_degree[_to]++;
+        });
 
-        for (size_t i = 0; i < vertices.size(); i++)
+        // Topological order of the blocks, only roots have edges
+        std::vector<int> order;
+        order.reserve(size);
+        for (int v = 0; v < size; v++)
+            if (_root[v] == v && in_degree[v] == 0) order.push_back(v);
+        for (size_t o = 0; o < order.size(); o++)
         {
-            const int vertex_idx = vertices[i]->idx;
-            if (_root[vertex_idx] == vertex_idx) place_block(vertex_idx);
+            const int b = order[o];
+            for (int e = block_offsets[b]; e < block_offsets[b + 1]; e++)
+                if (--in_degree[block_edges[e]] == 0) order.push_back(block_edges[e]);
         }
 
-        for (size_t i = 0; i < _vertices_per_layer.size(); i++)
+        // Every block as far to the left as its left neighbors allow, then as far right as its right neighbors allow
+        std::vector<float> x(size, 0);
+        for (const int b : order)
+            for (int e = block_offsets[b]; e < block_offsets[b + 1]; e++)
+                x[block_edges[e]] = std::max(x[block_edges[e]], x[b] + _delta);
+        for (auto it = order.rbegin(); it != order.rend(); ++it)
         {
-            const int v_1 = _vertices_per_layer[i][0];
-            if (sink[v_1] != v_1) continue;
-            if (shift[sink[v_1]] == infinite) shift[sink[v_1]] = 0;
-
-            int j = i;
-            int k = 0;
-            int v = undefined;
-            do
-            {
-                v = _vertices_per_layer[j][k];
-                while (_align[v] != _root[v])
-                {
-                    v = _align[v];
-                    j--;
-                    if (_pos_per_vertex[v] > 0)
-                    {
-                        const int layer = _layer_per_vertex[v];
-                        const int u = _vertices_per_layer[layer][_pos_per_vertex[v] - 1];
-                        shift[sink[u]] = std::min(shift[sink[u]],
-                                                  shift[sink[v]] + _x_per_vertex[v] - (_x_per_vertex[u] + _delta));
-                    }
-                }
-                k = _pos_per_vertex[v] + 1;
-            }
-            while (k < _vertices_per_layer[j].size() && sink[v] == sink[_vertices_per_layer[j][k]]);
+            const int b = *it;
+            float min = MAX_FLOAT;
+            for (int e = block_offsets[b]; e < block_offsets[b + 1]; e++)
+                min = std::min(min, x[block_edges[e]] - _delta);
+            if (min != MAX_FLOAT) x[b] = std::max(x[b], min);
         }
 
-        for (int i = 0; i < vertices.size(); i++)
-            _x_per_vertex[i] = _x_per_vertex[i] + shift[sink[i]];
+        // Mirrored for the alignments from the right
+        _x_per_vertex.resize(size);
+        for (int v = 0; v < size; v++)
+            _x_per_vertex[v] = _from_left ? x[_root[v]] : -x[_root[v]];
     }
 } // namespace DataVis
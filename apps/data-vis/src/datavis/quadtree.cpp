@@ -0,0 +1,131 @@
+#include "precomp.h"
+
+namespace DataVis
+{
+//--------------------------------------------------------------
+// QuadTree
+//--------------------------------------------------------------
+void QuadTree::Build(const std::vector<glm::vec2>& _points)
+{
+    m_cells.clear();
+    if (_points.empty()) return;
+
+    // Square root cell around all points
+    glm::vec2 min(MAX_FLOAT), max(-MAX_FLOAT);
+    for (const auto& p : _points)
+    {
+        min = glm::min(min, p);
+        max = glm::max(max, p);
+    }
+    m_cells.reserve(_points.size() * 2);
+    Cell& root = m_cells.emplace_back();
+    root.min = min;
+    root.size = std::max(std::max(max.x - min.x, max.y - min.y), 1e-3f);
+
+    for (int i = 0; i < _points.size(); i++)
+        Insert(i, _points);
+
+    for (auto& cell : m_cells)
+    {
+        if (cell.mass > 0) cell.center /= static_cast<float>(cell.mass);
+    }
+}
+
+//--------------------------------------------------------------
+int QuadTree::Quadrant(const Cell& _cell, const glm::vec2& _p) const
+{
+    const float half = _cell.size * .5f;
+    const int right = _p.x >= _cell.min.x + half ? 1 : 0;
+    const int bottom = _p.y >= _cell.min.y + half ? 2 : 0;
+    return right + bottom;
+}
+
+//--------------------------------------------------------------
+void QuadTree::Subdivide(int _cell)
+{
+    const int first = m_cells.size();
+    const glm::vec2 min = m_cells[_cell].min;
+    const float half = m_cells[_cell].size * .5f;
+    for (int i = 0; i < 4; i++)
+    {
+        Cell& child = m_cells.emplace_back();
+        child.min = min + glm::vec2((i & 1) * half, (i >> 1) * half);
+        child.size = half;
+    }
+    m_cells[_cell].children = first;
+}
+
+//--------------------------------------------------------------
+void QuadTree::Insert(int _point, const std::vector<glm::vec2>& _points)
+{
+    const glm::vec2& p = _points[_point];
+    int cell = 0;
+    for (int depth = 0;; depth++)
+    {
+        m_cells[cell].center += p;
+        m_cells[cell].mass++;
+
+        // Internal cell, descend
+        if (m_cells[cell].children != -1)
+        {
+            cell = m_cells[cell].children + Quadrant(m_cells[cell], p);
+            continue;
+        }
+        // Empty leaf
+        if (m_cells[cell].mass == 1)
+        {
+            m_cells[cell].point = _point;
+            return;
+        }
+        // Occupied leaf at maximum depth keeps the points as a single body
+        if (depth >= MAX_DEPTH)
+        {
+            m_cells[cell].point = -1;
+            return;
+        }
+        // Occupied leaf, push the existing point one level down
+        const int existing = m_cells[cell].point;
+        m_cells[cell].point = -1;
+        Subdivide(cell);
+        const glm::vec2& q = _points[existing];
+        Cell& child = m_cells[m_cells[cell].children + Quadrant(m_cells[cell], q)];
+        child.center = q;
+        child.mass = 1;
+        child.point = existing;
+        cell = m_cells[cell].children + Quadrant(m_cells[cell], p);
+    }
+}
+
+//--------------------------------------------------------------
+glm::vec2 QuadTree::Repulsion(const glm::vec2& _p, int _self, float _k2, float _theta) const
+{
+    glm::vec2 force(0);
+    if (m_cells.empty()) return force;
+
+    const float theta2 = _theta * _theta;
+    int stack[4 * MAX_DEPTH + 4];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        const Cell& cell = m_cells[stack[--top]];
+        if (cell.mass == 0) continue;
+        if (cell.point == _self) continue;
+
+        const glm::vec2 delta = _p - cell.center;
+        const float distance2 = glm::dot(delta, delta);
+        // Far enough away or a leaf, treat the cell as a single body. A cell around p is always opened, for
+        // theta above 1 / sqrt(2) it could pass the test and p would repel itself through its center of mass
+        const bool contains = _p.x >= cell.min.x && _p.x <= cell.min.x + cell.size && _p.y >= cell.min.y && _p.y <= cell.min.y + cell.size;
+        if (cell.children == -1 || (!contains && cell.size * cell.size < theta2 * distance2))
+        {
+            if (distance2 <= 0) continue;
+            force += delta * (_k2 * static_cast<float>(cell.mass) / distance2);
+            continue;
+        }
+        for (int i = 0; i < 4; i++)
+            stack[top++] = cell.children + i;
+    }
+    return force;
+}
+} // namespace DataVis
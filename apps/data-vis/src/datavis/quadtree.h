@@ -0,0 +1,47 @@
+#pragma once
+
+namespace DataVis
+{
+//--------------------------------------------------------------
+// QuadTree
+//--------------------------------------------------------------
+/**
+ * Barnes-Hut quadtree over a set of 2D points, every point has unit mass.
+ * Cells are stored in a flat vector and rebuilt from scratch with Build.
+ */
+class QuadTree
+{
+public:
+    QuadTree() = default;
+    void Build(const std::vector<glm::vec2>& points);
+
+    /**
+     * \brief Sums k2 * (p - q) / |p - q|^2 over all points q, approximating far away cells by their center of mass.
+     * \param self index of the point at p, it is skipped
+     * \param theta cell size / distance below which a cell is approximated, 0 is exact. Cells containing p are never approximated
+     */
+    [[nodiscard]] glm::vec2 Repulsion(const glm::vec2& p, int self, float k2, float theta) const;
+
+private:
+    struct Cell
+    {
+        glm::vec2 min = glm::vec2(0);
+        float size = 0;
+        // Center of mass once the tree is built, sum of positions while building
+        glm::vec2 center = glm::vec2(0);
+        int mass = 0;
+        // Index of the first of four children, -1 for leaves
+        int children = -1;
+        // Point stored in a leaf, -1 when empty
+        int point = -1;
+    };
+
+    void Insert(int point, const std::vector<glm::vec2>& points);
+    void Subdivide(int cell);
+    [[nodiscard]] int Quadrant(const Cell&, const glm::vec2&) const;
+
+    std::vector<Cell> m_cells;
+    // Prevents endless subdivision when points coincide
+    static constexpr int MAX_DEPTH = 24;
+};
+} // namespace DataVis
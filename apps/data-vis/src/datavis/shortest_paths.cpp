@@ -0,0 +1,155 @@
+#include "precomp.h"
+
+namespace DataVis
+{
+namespace ShortestPaths
+{
+namespace
+{
+    float EdgeWeight(const Edge& _edge)
+    {
+        const auto it = _edge.attributes.map.find("weight");
+        if (it == _edge.attributes.map.end()) return 1.f;
+        return std::visit(VisitFloat{1.f}, it->second);
+    }
+
+    // The adjacency of the dataset plus the weight of every edge
+    struct WeightedAdjacency
+    {
+        const Adjacency& adjacency;
+        std::vector<float> weights;
+        bool weighted = false;
+
+        explicit WeightedAdjacency(const Dataset& _dataset) :
+            adjacency(_dataset.GetAdjacency())
+        {
+            weights.resize(_dataset.edges.size());
+            for (size_t i = 0; i < _dataset.edges.size(); i++)
+            {
+                weights[i] = EdgeWeight(_dataset.edges[i]);
+                weighted |= weights[i] != 1.f;
+            }
+        }
+    };
+
+    //--------------------------------------------------------------
+    void BFS(const WeightedAdjacency& _adjacency, VertexIdx _source, std::vector<double>& _distances)
+    {
+        std::vector<VertexIdx> queue;
+        queue.reserve(_distances.size());
+        _distances[_source] = 0;
+        queue.push_back(_source);
+        for (size_t head = 0; head < queue.size(); head++)
+        {
+            const VertexIdx v = queue[head];
+            const double next = _distances[v] + 1;
+            for (const Neighbor neighbor : _adjacency.adjacency.Outgoing(v))
+            {
+                const VertexIdx u = neighbor.idx;
+                if (_distances[u] != MAX_FLOAT) continue;
+                _distances[u] = next;
+                queue.push_back(u);
+            }
+        }
+    }
+
+    //--------------------------------------------------------------
+    void Dijkstra(const WeightedAdjacency& _adjacency, VertexIdx _source, std::vector<double>& _distances)
+    {
+        using Entry = std::pair<double, VertexIdx>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<>> queue;
+        _distances[_source] = 0;
+        queue.emplace(0, _source);
+        while (!queue.empty())
+        {
+            const auto [distance, v] = queue.top();
+            queue.pop();
+            // Stale entry, v was already settled with a shorter distance
+            if (distance > _distances[v]) continue;
+            for (const Neighbor neighbor : _adjacency.adjacency.Outgoing(v))
+            {
+                const VertexIdx u = neighbor.idx;
+                const double new_distance = distance + _adjacency.weights[neighbor.edge_idx];
+                if (new_distance < _distances[u])
+                {
+                    _distances[u] = new_distance;
+                    queue.emplace(new_distance, u);
+                }
+            }
+        }
+    }
+
+    //--------------------------------------------------------------
+    void Search(const WeightedAdjacency& _adjacency, VertexIdx _source, std::vector<double>& _distances)
+    {
+        std::fill(_distances.begin(), _distances.end(), MAX_FLOAT);
+        if (_adjacency.weighted)
+            Dijkstra(_adjacency, _source, _distances);
+        else
+            BFS(_adjacency, _source, _distances);
+    }
+} // namespace
+
+//--------------------------------------------------------------
+bool IsWeighted(const Dataset& _dataset)
+{
+    for (const auto& edge : _dataset.edges)
+    {
+        if (EdgeWeight(edge) != 1.f) return true;
+    }
+    return false;
+}
+
+//--------------------------------------------------------------
+void SingleSource(const Dataset& _dataset, VertexIdx _source, std::vector<double>& _distances)
+{
+    const WeightedAdjacency adjacency(_dataset);
+    _distances.resize(_dataset.vertices.size());
+    Search(adjacency, _source, _distances);
+}
+
+//--------------------------------------------------------------
+void AllPairs(const Dataset& _dataset, qdtsne::NeighborList<int, double>& _D)
+{
+    const WeightedAdjacency adjacency(_dataset);
+    const int size = _dataset.vertices.size();
+    _D.clear();
+    _D.resize(size);
+
+    ThreadPool::Global().ParallelFor(0, size, [&](int i)
+    {
+        std::vector<double> distances(size);
+        Search(adjacency, i, distances);
+
+        // Leave out itself and sort in increasing distance
+        auto& entry = _D[i];
+        entry.reserve(size - 1);
+        for (int j = 0; j < size; j++)
+        {
+            if (i == j) continue;
+            entry.emplace_back(j, distances[j]);
+        }
+        std::sort(entry.begin(), entry.end(), [](const std::pair<int, double>& lhs, const std::pair<int, double>& rhs) {
+            return lhs.second < rhs.second;
+        });
+    });
+}
+
+//--------------------------------------------------------------
+void AllPairs(const Dataset& _dataset, std::unique_ptr<smat::Matrix<double>>& _D)
+{
+    const WeightedAdjacency adjacency(_dataset);
+    const int size = _dataset.vertices.size();
+    _D = std::make_unique<smat::Matrix<double>>(size, size, MAX_FLOAT);
+
+    // Each task only writes its own row
+    ThreadPool::Global().ParallelFor(0, size, [&](int i)
+    {
+        std::vector<double> distances(size);
+        Search(adjacency, i, distances);
+        for (int j = 0; j < size; j++)
+            _D->set(i, j, distances[j]);
+    });
+}
+} // namespace ShortestPaths
+} // namespace DataVis
@@ -0,0 +1,35 @@
+#pragma once
+
+namespace DataVis
+{
+//--------------------------------------------------------------
+// All Pairs Shortest Paths
+//--------------------------------------------------------------
+/**
+ * Runs one single source search per vertex, spread over the global thread pool.
+ * Unweighted graphs use BFS, weighted graphs use Dijkstra. Unreachable pairs get MAX_FLOAT,
+ * which matches the output of FloydWarshall.
+ */
+namespace ShortestPaths
+{
+    // True when any edge has a weight attribute different from the default of 1
+    bool IsWeighted(const Dataset&);
+
+    /**
+     * \brief Calculates the graph-theoretic distance to be used for dimensionality reduction algorithms.
+     * \param _dataset
+     * \param _D T-SNE datastructure, per vertex all other vertices sorted in increasing distance
+     */
+    void AllPairs(const Dataset& _dataset, qdtsne::NeighborList<int, double>& _D);
+
+    /**
+     * \brief Calculates the graph-theoretic distance to be used for dimensionality reduction algorithms.
+     * \param _dataset
+     * \param _D MDS datastructure
+     */
+    void AllPairs(const Dataset& _dataset, std::unique_ptr<smat::Matrix<double>>& _D);
+
+    // Distances from a single source to every vertex
+    void SingleSource(const Dataset&, VertexIdx source, std::vector<double>& distances);
+} // namespace ShortestPaths
+} // namespace DataVis
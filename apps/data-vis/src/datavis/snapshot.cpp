@@ -0,0 +1,277 @@
+#include "precomp.h"
+
+namespace DataVis
+{
+namespace Snapshot
+{
+namespace bip = boost::interprocess;
+
+namespace
+{
+    constexpr char MAGIC[8] = {'D', 'V', 'S', 'N', 'A', 'P', '\0', '\0'};
+    // Bump whenever the layout written by Dataset::WriteSnapshot changes
+    constexpr uint32_t VERSION = 1;
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint8_t cluster;
+        uint64_t source_size;
+        int64_t source_mtime;
+        uint64_t source_hash;
+    };
+
+    enum AttributeType : uint8_t { None, Float, String };
+
+    std::string SourcePath(const std::string& _filename)
+    {
+        return ofToDataPath(_filename, false);
+    }
+
+    std::string SnapshotPath(const std::string& _filename)
+    {
+        return ofToDataPath(_filename + ".snapshot", false);
+    }
+
+    // FNV-1a over the whole source file
+    uint64_t Hash(const std::string& _path)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        if (std::filesystem::file_size(_path) == 0) return hash;
+        const bip::file_mapping file(_path.c_str(), bip::read_only);
+        const bip::mapped_region region(file, bip::read_only);
+        const auto* it = static_cast<const unsigned char*>(region.get_address());
+        const auto* end = it + region.get_size();
+        for (; it != end; ++it)
+        {
+            hash ^= *it;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    int64_t ModificationTime(const std::string& _path)
+    {
+        return std::filesystem::last_write_time(_path).time_since_epoch().count();
+    }
+
+    // Size and mtime are enough when they match, an edited timestamp with the same content only costs a hash.
+    // Sets touched when only the timestamp changed, so the caller can store the new one
+    bool UpToDate(const Header& _header, const std::string& _source, bool& _touched)
+    {
+        _touched = false;
+        if (std::filesystem::file_size(_source) != _header.source_size) return false;
+        if (ModificationTime(_source) == _header.source_mtime) return true;
+        _touched = Hash(_source) == _header.source_hash;
+        return _touched;
+    }
+
+    // Rewrites the header in place with the current modification time of the source, the rest of the snapshot is unchanged
+    void Touch(const std::string& _path, Header _header, const std::string& _source)
+    {
+        _header.source_mtime = ModificationTime(_source);
+        std::fstream file(_path, std::ios::binary | std::ios::in | std::ios::out);
+        file.write(reinterpret_cast<const char*>(&_header), sizeof(Header));
+        if (!file) std::cout << "W/Snapshot::Load: Failed to update the header of " << _path << std::endl;
+    }
+} // namespace
+
+//--------------------------------------------------------------
+// Writer / Reader
+//--------------------------------------------------------------
+void Writer::WriteString(std::string_view _value)
+{
+    Write<uint32_t>(_value.size());
+    m_buffer.insert(m_buffer.end(), _value.begin(), _value.end());
+}
+
+std::string_view Reader::ReadString()
+{
+    const uint32_t size = Read<uint32_t>();
+    return { Take(size), size };
+}
+
+const char* Reader::Take(size_t _bytes)
+{
+    if (_bytes > static_cast<size_t>(m_end - m_it))
+        throw std::runtime_error("snapshot is truncated");
+    const char* begin = m_it;
+    m_it += _bytes;
+    return begin;
+}
+
+//--------------------------------------------------------------
+// Columns
+//--------------------------------------------------------------
+void WriteAttributes(Writer& _writer, size_t _rows, const std::function<const Attributes&(size_t)>& _row)
+{
+    // One column per key, in order of first appearance
+    std::vector<std::string> keys;
+    std::unordered_map<std::string, size_t> key_idx;
+    for (size_t i = 0; i < _rows; i++)
+        for (const auto& [key, value] : _row(i).map)
+            if (key_idx.emplace(key, keys.size()).second)
+                keys.push_back(key);
+
+    _writer.Write<uint64_t>(keys.size());
+    std::vector<uint8_t> types(_rows);
+    std::vector<float> floats(_rows);
+    for (const auto& key : keys)
+    {
+        _writer.WriteString(key);
+        for (size_t i = 0; i < _rows; i++)
+        {
+            const auto& map = _row(i).map;
+            const auto it = map.find(key);
+            types[i] = it == map.end() ? None : std::holds_alternative<float>(it->second) ? Float : String;
+            floats[i] = types[i] == Float ? std::get<float>(it->second) : 0.f;
+        }
+        _writer.WriteArray(types);
+        _writer.WriteArray(floats);
+        for (size_t i = 0; i < _rows; i++)
+            if (types[i] == String)
+                _writer.WriteString(std::get<std::string>(_row(i).map.at(key)));
+    }
+}
+
+void ReadAttributes(Reader& _reader, size_t _rows, const std::function<Attributes&(size_t)>& _row)
+{
+    const uint64_t columns = _reader.Read<uint64_t>();
+    std::vector<uint8_t> types;
+    std::vector<float> floats;
+    for (uint64_t c = 0; c < columns; c++)
+    {
+        const std::string key(_reader.ReadString());
+        _reader.ReadArray(types);
+        _reader.ReadArray(floats);
+        if (types.size() != _rows || floats.size() != _rows)
+            throw std::runtime_error("attribute column has the wrong size");
+        for (size_t i = 0; i < _rows; i++)
+        {
+            if (types[i] == Float)
+                _row(i).map.emplace(key, floats[i]);
+            else if (types[i] == String)
+                _row(i).map.emplace(key, std::string(_reader.ReadString()));
+        }
+    }
+}
+
+void WriteEdges(Writer& _writer, const std::vector<Edge>& _edges)
+{
+    std::vector<EdgeIdx> idx(_edges.size());
+    std::vector<VertexIdx> from(_edges.size()), to(_edges.size());
+    for (size_t i = 0; i < _edges.size(); i++)
+    {
+        idx[i] = _edges[i].idx;
+        from[i] = _edges[i].from_idx;
+        to[i] = _edges[i].to_idx;
+    }
+    _writer.WriteArray(idx);
+    _writer.WriteArray(from);
+    _writer.WriteArray(to);
+    WriteAttributes(_writer, _edges.size(), [&](size_t i) -> const Attributes& { return _edges[i].attributes; });
+}
+
+void ReadEdges(Reader& _reader, std::vector<Edge>& _edges, size_t _vertex_count)
+{
+    std::vector<EdgeIdx> idx;
+    std::vector<VertexIdx> from, to;
+    _reader.ReadArray(idx);
+    _reader.ReadArray(from);
+    _reader.ReadArray(to);
+    if (from.size() != idx.size() || to.size() != idx.size())
+        throw std::runtime_error("edge columns have different sizes");
+
+    _edges.resize(idx.size());
+    for (size_t i = 0; i < idx.size(); i++)
+    {
+        if (from[i] < 0 || to[i] < 0 || static_cast<size_t>(std::max(from[i], to[i])) >= _vertex_count)
+            throw std::runtime_error("edge endpoint out of range");
+        _edges[i].idx = idx[i];
+        _edges[i].from_idx = from[i];
+        _edges[i].to_idx = to[i];
+    }
+    ReadAttributes(_reader, _edges.size(), [&](size_t i) -> Attributes& { return _edges[i].attributes; });
+}
+
+//--------------------------------------------------------------
+// Load / Save
+//--------------------------------------------------------------
+std::shared_ptr<Dataset> Load(const std::string& _filename)
+{
+    const std::string path = SnapshotPath(_filename);
+    const std::string source = SourcePath(_filename);
+    if (!std::filesystem::exists(path) || !std::filesystem::exists(source))
+        return nullptr;
+
+    try
+    {
+        Header header;
+        bool touched = false;
+        std::shared_ptr<Dataset> dataset;
+        {
+            const bip::file_mapping file(path.c_str(), bip::read_only);
+            const bip::mapped_region region(file, bip::read_only);
+            const char* begin = static_cast<const char*>(region.get_address());
+            Reader reader(begin, begin + region.get_size());
+
+            header = reader.Read<Header>();
+            if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION)
+            {
+                std::cout << "W/Snapshot::Load: Unknown snapshot format, ignoring " << path << std::endl;
+                return nullptr;
+            }
+            if (!UpToDate(header, source, touched))
+                return nullptr;
+
+            dataset = header.cluster ? std::make_shared<ClusterDataset>() : std::make_shared<Dataset>();
+            dataset->Load(reader, _filename);
+        }
+        // After the mapping is released
+        if (touched) Touch(path, header, source);
+        return dataset;
+    }
+    catch (std::exception& e)
+    {
+        std::cout << "W/Snapshot::Load: Failed to read " << path << ": " << e.what() << std::endl;
+        return nullptr;
+    }
+}
+
+bool Save(const Dataset& _dataset, const std::string& _filename)
+{
+    const std::string path = SnapshotPath(_filename);
+    const std::string source = SourcePath(_filename);
+    try
+    {
+        Header header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.cluster = dynamic_cast<const ClusterDataset*>(&_dataset) != nullptr;
+        header.source_size = std::filesystem::file_size(source);
+        header.source_mtime = ModificationTime(source);
+        header.source_hash = Hash(source);
+
+        Writer writer;
+        writer.Write(header);
+        _dataset.WriteSnapshot(writer);
+
+        // Write next to the snapshot and swap it in, so a crash never leaves a half written snapshot behind
+        const std::string temp = path + ".tmp";
+        {
+            std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+            file.write(writer.GetBuffer().data(), writer.GetBuffer().size());
+            if (!file) throw std::runtime_error("write failed");
+        }
+        std::filesystem::rename(temp, path);
+        return true;
+    }
+    catch (std::exception& e)
+    {
+        std::cout << "W/Snapshot::Save: Failed to write " << path << ": " << e.what() << std::endl;
+        return false;
+    }
+}
+} // namespace Snapshot
+} // namespace DataVis
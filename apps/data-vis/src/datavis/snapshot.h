@@ -0,0 +1,98 @@
+#pragma once
+
+namespace DataVis
+{
+//--------------------------------------------------------------
+// Dataset Snapshots
+//--------------------------------------------------------------
+/**
+ * Binary copy of a loaded dataset, stored next to its .dot file as <name>.dot.snapshot.
+ * It holds the vertex ids and owners, the edges, the CSR adjacency and the attributes as typed columns.
+ * A snapshot is only used while the size and modification time of the .dot file match,
+ * or when they changed but the content hash still matches.
+ */
+namespace Snapshot
+{
+    // Appends plain values and length prefixed arrays to a byte buffer
+    class Writer
+    {
+    public:
+        template <typename T>
+        void Write(const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            const char* bytes = reinterpret_cast<const char*>(&value);
+            m_buffer.insert(m_buffer.end(), bytes, bytes + sizeof(T));
+        }
+
+        template <typename T>
+        void WriteArray(const std::vector<T>& values)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            Write<uint64_t>(values.size());
+            const char* bytes = reinterpret_cast<const char*>(values.data());
+            m_buffer.insert(m_buffer.end(), bytes, bytes + values.size() * sizeof(T));
+        }
+
+        void WriteString(std::string_view value);
+        [[nodiscard]] const std::vector<char>& GetBuffer() const { return m_buffer; }
+
+    private:
+        std::vector<char> m_buffer;
+    };
+
+    // Reads back what Writer wrote from a mapped file, throws std::runtime_error when running out of bytes
+    class Reader
+    {
+    public:
+        Reader(const char* begin, const char* end) : m_it(begin), m_end(end) {}
+
+        template <typename T>
+        T Read()
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            T value;
+            std::memcpy(&value, Take(sizeof(T)), sizeof(T));
+            return value;
+        }
+
+        template <typename T>
+        void ReadArray(std::vector<T>& values)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            const uint64_t size = Read<uint64_t>();
+            // Checked before the resize, a corrupt size must not allocate or overflow
+            if (size > Remaining() / sizeof(T))
+                throw std::runtime_error("snapshot is truncated");
+            values.resize(size);
+            std::memcpy(values.data(), Take(size * sizeof(T)), size * sizeof(T));
+        }
+
+        // View into the mapped file
+        std::string_view ReadString();
+
+    private:
+        const char* Take(size_t bytes);
+        [[nodiscard]] size_t Remaining() const { return static_cast<size_t>(m_end - m_it); }
+
+        const char* m_it;
+        const char* m_end;
+    };
+
+    // Attributes of a table of rows (vertices or edges) as one column per key: a type byte and a float per row,
+    // followed by the string values of the rows that hold a string
+    void WriteAttributes(Writer&, size_t rows, const std::function<const Attributes&(size_t)>& row);
+    void ReadAttributes(Reader&, size_t rows, const std::function<Attributes&(size_t)>& row);
+    void WriteEdges(Writer&, const std::vector<Edge>&);
+    void ReadEdges(Reader&, std::vector<Edge>&, size_t vertex_count);
+
+    /**
+     * \brief Loads the snapshot of a .dot file in the data folder.
+     * \return null when there is no snapshot, it is out of date or it can not be read
+     */
+    std::shared_ptr<Dataset> Load(const std::string& filename);
+
+    // Writes the snapshot of a dataset loaded from the given .dot file in the data folder
+    bool Save(const Dataset&, const std::string& filename);
+} // namespace Snapshot
+} // namespace DataVis
@@ -46,6 +46,8 @@ void Clusters::Init(const std::shared_ptr<Dataset> _dataset)
 //--------------------------------------------------------------
 void Clusters::Update(const float _delta_time)
 {
+	m_edges_rebuilt_frame = m_edges_rebuilt;
+	m_edges_rebuilt = 0;
 	m_aabb.Update(_delta_time);
 	for (const auto& graph : sub_graphs)
 		graph->Update(_delta_time);
@@ -53,52 +55,82 @@ void Clusters::Update(const float _delta_time)
 		edge->Update(_delta_time);
 	if (m_active_layout)
 		m_active_layout->Update(_delta_time);
-	UpdateEdges(true);
+	PollLayoutJobs();
+	UpdateMovedEdges();
 }
 
 //--------------------------------------------------------------
 void Clusters::UpdateEdges(bool _force)
 {
-	// Loop over inter edges
-	for (int i = 0; i < edges.size(); i++)
+	for (size_t i = 0; i < m_inter_edges.size(); i++)
 	{
-		const auto& edge = dataset->edges[i];
-		auto const& start_vertex = dataset->vertices[edge.from_idx];
-		auto const& end_vertex = dataset->vertices[edge.to_idx];
-		auto const& start_graph = FindSubGraph(start_vertex->owner);
-		auto const& end_graph = FindSubGraph(end_vertex->owner);
-
-		glm::vec3 start = start_graph->nodes[start_vertex->idx]->GetNewPosition() + start_graph->GetPosition();
-		glm::vec3 end = end_graph->nodes[end_vertex->idx]->GetNewPosition() + end_graph->GetPosition();
+		const auto& inter_edge = m_inter_edges[i];
+		UpdateEdge(i, inter_edge.from->GetNewPosition() + sub_graphs[inter_edge.from_graph]->GetPosition(),
+			inter_edge.to->GetNewPosition() + sub_graphs[inter_edge.to_graph]->GetPosition(), _force);
+	}
+}
 
-		const auto& edge_path = edges[i];
-		edge_path->UpdateStartPoint(start);
-		edge_path->UpdateEndPoint(end);
-		if (_force) edge_path->ForceUpdate();
-		edge_path->SetArrowOffset(end_graph->nodes[end_vertex->idx]->GetRadius() * 2);
+//--------------------------------------------------------------
+void Clusters::UpdateMovedEdges()
+{
+	for (size_t i = 0; i < m_inter_edges.size(); i++)
+	{
+		const auto& inter_edge = m_inter_edges[i];
+		const glm::vec3 start = inter_edge.from->GetNewPosition() + sub_graphs[inter_edge.from_graph]->GetPosition();
+		const glm::vec3 end = inter_edge.to->GetNewPosition() + sub_graphs[inter_edge.to_graph]->GetPosition();
+		if (start != inter_edge.start || end != inter_edge.end || inter_edge.to->GetRadius() != inter_edge.radius)
+			UpdateEdge(i, start, end, true);
 	}
 }
 
+//--------------------------------------------------------------
+void Clusters::UpdateEdge(size_t _i, const glm::vec3& _start, const glm::vec3& _end, bool _force)
+{
+	auto& inter_edge = m_inter_edges[_i];
+	inter_edge.start = _start;
+	inter_edge.end = _end;
+	inter_edge.radius = inter_edge.to->GetRadius();
+
+	const auto& edge_path = edges[_i];
+	edge_path->UpdateStartPoint(_start);
+	edge_path->UpdateEndPoint(_end);
+	// Before the forced rebuild, which places the arrow
+	edge_path->SetArrowOffset(inter_edge.radius * 2);
+	if (_force) edge_path->ForceUpdate();
+	m_edges_rebuilt++;
+}
+
 //--------------------------------------------------------------
 void Clusters::InitEdges()
 {
 	edges.clear();
+	m_inter_edges.clear();
+
+	// Resolve the owners once, the vertices only know the id of their sub-graph
+	std::unordered_map<std::string, int> graph_idx;
+	for (int g = 0; g < sub_graphs.size(); g++)
+		graph_idx[sub_graphs[g]->dataset->GetId()] = g;
+
 	// Loop over inter edges
 	for (int i = 0; i < dataset->edges.size(); i++)
 	{
 		const auto& edge = dataset->edges[i];
 		auto const& start_vertex = dataset->vertices[edge.from_idx];
 		auto const& end_vertex = dataset->vertices[edge.to_idx];
-		auto const& start_graph = FindSubGraph(start_vertex->owner);
-		auto const& end_graph = FindSubGraph(end_vertex->owner);
 
-		glm::vec3 start = start_graph->nodes[start_vertex->idx]->GetNewPosition() + start_graph->GetPosition();
-		glm::vec3 end = end_graph->nodes[end_vertex->idx]->GetNewPosition() + end_graph->GetPosition();
+		auto& inter_edge = m_inter_edges.emplace_back();
+		inter_edge.from_graph = graph_idx.at(start_vertex->owner);
+		inter_edge.to_graph = graph_idx.at(end_vertex->owner);
+		inter_edge.from = sub_graphs[inter_edge.from_graph]->nodes[start_vertex->idx].get();
+		inter_edge.to = sub_graphs[inter_edge.to_graph]->nodes[end_vertex->idx].get();
+		inter_edge.start = inter_edge.from->GetNewPosition() + sub_graphs[inter_edge.from_graph]->GetPosition();
+		inter_edge.end = inter_edge.to->GetNewPosition() + sub_graphs[inter_edge.to_graph]->GetPosition();
+		inter_edge.radius = inter_edge.to->GetRadius();
 
 		const auto& edge_path = edges.emplace_back(std::make_shared<EdgePath>(edge.idx, dataset->GetKind()));
-		edge_path->AddPoint(start);
-		edge_path->AddPoint(end);
-		edge_path->SetArrowOffset(end_graph->nodes[end_vertex->idx]->GetRadius() * 2);
+		edge_path->AddPoint(inter_edge.start);
+		edge_path->AddPoint(inter_edge.end);
+		edge_path->SetArrowOffset(inter_edge.radius * 2);
 	}
 }
 
@@ -176,16 +208,6 @@ void Clusters::Select(const glm::vec3& _pos)
 	}
 }
 
-//--------------------------------------------------------------
-std::shared_ptr<Graph> Clusters::FindSubGraph(const std::string _id)
-{
-	for (auto& graph : sub_graphs)
-	{
-		if (graph->dataset->GetId() == _id) return graph;
-	}
-	return nullptr;
-}
-
 //--------------------------------------------------------------
 void Clusters::DrawNodes()
 {
@@ -220,6 +242,7 @@ void Clusters::Gui()
 	}
 
 	dataset->InfoGui();
+	ImGui::Text("Inter edges rebuilt: %d / frame", m_edges_rebuilt_frame);
 
 	if (ImGui::TreeNode("Settings"))
 	{
@@ -33,6 +33,20 @@ private:
 		glm::vec4 coloredit_inter_edge_color = glm::vec4(123, 123, 123, 255);
 	} m_gui_data;
 
-	std::shared_ptr<Graph> FindSubGraph(const std::string id);
+	// Inter edge with the owners of its vertices resolved once, and the end points of its last update
+	struct InterEdge
+	{
+		int from_graph = -1, to_graph = -1;
+		// Owned by the sub-graphs
+		Node* from = nullptr;
+		Node* to = nullptr;
+		glm::vec3 start = glm::vec3(0), end = glm::vec3(0);
+		float radius = 0;
+	};
+	std::vector<InterEdge> m_inter_edges;
+
+	// Only the inter edges whose sub-graph moved or whose nodes got a new position or radius, without animation
+	void UpdateMovedEdges();
+	void UpdateEdge(size_t i, const glm::vec3& start, const glm::vec3& end, bool force);
 };
 }
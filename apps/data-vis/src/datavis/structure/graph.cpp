@@ -33,7 +33,6 @@ void Graph::DrawNodes()
     }
     for (const auto& node : nodes)
     {
-        if (node->GetVertexId() == "dummy") continue;
         node->Draw();
     }
 }
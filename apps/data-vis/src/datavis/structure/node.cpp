@@ -70,6 +70,7 @@ const glm::vec3& Node::GetPosition()
 
 void Node::SetPosition(const glm::vec3& _new_position)
 {
+    m_dirty |= m_position.new_value != _new_position;
     m_position.value = _new_position;
     m_position.old_value = _new_position;
     m_position.new_value = _new_position;
@@ -82,6 +83,7 @@ const glm::vec3& Node::GetNewPosition()
 
 void Node::SetNewPosition(const glm::vec3& _new_position)
 {
+    m_dirty |= m_position.new_value != _new_position;
     m_position.new_value = _new_position;
     m_aabb.setPosition(_new_position - glm::vec2(m_radius));
     StartAnimation();
@@ -97,10 +99,24 @@ const float& Node::GetRadius() const
 
 void Node::SetRadius(float _radius)
 {
+    m_dirty |= m_radius != _radius;
     m_radius = _radius;
     m_aabb.setSize(_radius * 2, _radius * 2);
 }
 
+//--------------------------------------------------------------
+// Dirty
+//--------------------------------------------------------------
+bool Node::IsDirty() const
+{
+    return m_dirty;
+}
+
+void Node::ClearDirty()
+{
+    m_dirty = false;
+}
+
 //--------------------------------------------------------------
 // Interaction
 //--------------------------------------------------------------
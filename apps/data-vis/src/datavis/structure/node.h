@@ -19,6 +19,9 @@ namespace DataVis
         [[nodiscard]] const float& GetRadius() const;
         void SetRadius(float radius);
         [[nodiscard]] bool Inside(const glm::vec3& position) const;
+        // Set when the new position or the radius changes, cleared once the incident edges followed
+        [[nodiscard]] bool IsDirty() const;
+        void ClearDirty();
 
         ofColor color = ofColor::black;
 
@@ -33,6 +36,7 @@ namespace DataVis
         glm::vec3 m_displacement = glm::vec3(0);
         ofRectangle m_aabb = {};
         float m_radius = 10;
+        bool m_dirty = true;
     };
     
     using VectorOfNodes = std::vector<std::shared_ptr<Node>>;
@@ -35,6 +35,8 @@ const int& IStructure::Idx() const
 
 void IStructure::Update(const float _delta_time)
 {
+    m_edges_rebuilt_frame = m_edges_rebuilt;
+    m_edges_rebuilt = 0;
     m_aabb.Update(_delta_time);
     for (const auto& node : nodes)
         node->Update(_delta_time);
@@ -42,6 +44,14 @@ void IStructure::Update(const float _delta_time)
         edge->Update(_delta_time);
     if (m_active_layout)
         m_active_layout->Update(_delta_time);
+    PollLayoutJobs();
+}
+
+void IStructure::PollLayoutJobs()
+{
+    // Layouts running in the background commit their result here, on the main thread
+    for (const auto& layout : m_layouts)
+        layout->job.Poll();
 }
 
 //--------------------------------------------------------------
@@ -63,22 +73,44 @@ void IStructure::SetPosition(const glm::vec3& _position)
 //--------------------------------------------------------------
 void IStructure::UpdateEdges(const bool _force)
 {
-    for (int i = 0; i < dataset->edges.size(); i++)
+    if (++m_stamp == 0)
     {
-        const auto& edge = dataset->edges[i];
-        auto const& startIdx = edge.from_idx;
-        auto const& endIdx = edge.to_idx;
-        glm::vec3 start = nodes[startIdx]->GetNewPosition();
-        glm::vec3 end = nodes[endIdx]->GetNewPosition();
-
-        const auto& edge_path = edges[i];
-        edge_path->UpdateStartPoint(start);
-        edge_path->UpdateEndPoint(end);
-        if(_force) edge_path->ForceUpdate();
-        edge_path->SetArrowOffset(nodes[endIdx]->GetRadius() * 2);
+        std::fill(m_edge_stamps.begin(), m_edge_stamps.end(), 0);
+        m_stamp = 1;
+    }
+    for (size_t v = 0; v < nodes.size(); v++)
+    {
+        if (!nodes[v]->IsDirty()) continue;
+        nodes[v]->ClearDirty();
+        for (int j = m_incident_offsets[v]; j < m_incident_offsets[v + 1]; j++)
+        {
+            const EdgeIdx i = m_incident_edges[j];
+            if (m_edge_stamps[i] == m_stamp) continue;
+            m_edge_stamps[i] = m_stamp;
+
+            const auto& edge = dataset->edges[i];
+            auto const& startIdx = edge.from_idx;
+            auto const& endIdx = edge.to_idx;
+            glm::vec3 start = nodes[startIdx]->GetNewPosition();
+            glm::vec3 end = nodes[endIdx]->GetNewPosition();
+
+            const auto& edge_path = edges[i];
+            edge_path->UpdateStartPoint(start);
+            edge_path->UpdateEndPoint(end);
+            // Before the forced rebuild, which places the arrow
+            edge_path->SetArrowOffset(nodes[endIdx]->GetRadius() * 2);
+            if(_force) edge_path->ForceUpdate();
+            m_edges_rebuilt++;
+        }
     }
 }
 
+//--------------------------------------------------------------
+int IStructure::EdgesRebuilt() const
+{
+    return m_edges_rebuilt_frame;
+}
+
 //--------------------------------------------------------------
 void IStructure::InitEdges()
 {
@@ -98,6 +130,27 @@ void IStructure::InitEdges()
         edge_path->AddPoint(end);
         edge_path->SetArrowOffset(nodes[endIdx]->GetRadius() * 2);
     }
+
+    // Incidence index, the edges now match the nodes
+    const auto& dataset_edges = dataset->edges;
+    m_incident_offsets.assign(nodes.size() + 1, 0);
+    for (const auto& edge : dataset_edges)
+    {
+        m_incident_offsets[edge.from_idx + 1]++;
+        if (edge.to_idx != edge.from_idx) m_incident_offsets[edge.to_idx + 1]++;
+    }
+    std::partial_sum(m_incident_offsets.begin(), m_incident_offsets.end(), m_incident_offsets.begin());
+    m_incident_edges.resize(m_incident_offsets.back());
+    std::vector<int> fill(m_incident_offsets.begin(), m_incident_offsets.end() - 1);
+    for (EdgeIdx i = 0; i < static_cast<EdgeIdx>(dataset_edges.size()); i++)
+    {
+        m_incident_edges[fill[dataset_edges[i].from_idx]++] = i;
+        if (dataset_edges[i].to_idx != dataset_edges[i].from_idx) m_incident_edges[fill[dataset_edges[i].to_idx]++] = i;
+    }
+    m_edge_stamps.assign(edges.size(), 0);
+    m_stamp = 0;
+    for (const auto& node : nodes)
+        node->ClearDirty();
 }
 
 //--------------------------------------------------------------
@@ -226,6 +279,7 @@ void IStructure::Gui()
     }
 
     dataset->InfoGui();
+    ImGui::Text("Edges rebuilt: %d / frame", m_edges_rebuilt_frame);
 
     if (ImGui::TreeNode("Settings"))
     {
@@ -263,7 +317,7 @@ void IStructure::Gui()
     ImGui::Separator();
     if (m_active_layout)
     {
-        m_active_layout->metrics->MetricGui();
+        m_active_layout->metrics->MetricGui( *this );
         ImGui::Separator();
     }
     // Call extra gui
@@ -16,7 +16,10 @@ public:
 	virtual void Update(const float delta_time);
 	[[nodiscard]] const glm::vec3& GetPosition() const;
 	void SetPosition(const glm::vec3&);
+	// Only the edges incident to dirty nodes
 	virtual void UpdateEdges(bool force = false);
+	// Edges rebuilt by UpdateEdges during the last frame
+	[[nodiscard]] int EdgesRebuilt() const;
 
 	// AABB
 	const AABB& GetAABB();
@@ -44,6 +47,7 @@ protected:
 	virtual void InitEdges();
 	virtual void InitNodes();
 	virtual void NodeInfoGui();
+	void PollLayoutJobs();
 	void SetSelectedNode(const std::shared_ptr<Node>& _node);
 
 	std::vector<std::shared_ptr<ILayout>> m_layouts;
@@ -52,6 +56,14 @@ protected:
 	glm::vec3 m_position = glm::vec3(0);
 	std::shared_ptr<Node> m_selected_node;
 
+	// Edges incident to every node in compressed sparse rows, built by InitEdges
+	std::vector<int> m_incident_offsets;
+	std::vector<EdgeIdx> m_incident_edges;
+	// An edge between two dirty nodes is rebuilt once per UpdateEdges
+	std::vector<uint> m_edge_stamps;
+	uint m_stamp = 0;
+	int m_edges_rebuilt = 0, m_edges_rebuilt_frame = 0;
+
 	struct GuiData
 	{
 		bool checkbox_node_labels = false;
@@ -8,75 +8,168 @@ namespace DataVis
         m_layouts.push_back(std::make_unique<RadialLayout>());
     }
 
-    std::shared_ptr<ITree::TreeNode> ITree::Root()
+    VertexIdx ITree::Root() const
     {
         return m_root;
     }
 
+    VertexIdx ITree::Parent(VertexIdx _v) const
+    {
+        return m_parent[_v];
+    }
+
+    VertexIdx ITree::FirstChild(VertexIdx _v) const
+    {
+        return m_first_child[_v];
+    }
+
+    VertexIdx ITree::NextSibling(VertexIdx _v) const
+    {
+        return m_next_sibling[_v];
+    }
+
+    const std::vector<VertexIdx>& ITree::Order() const
+    {
+        return m_order;
+    }
+
+    //--------------------------------------------------------------
+    // Topology
+    //--------------------------------------------------------------
+    void ITree::BuildTopology(const std::vector<VertexIdx>& _parents, VertexIdx _root)
+    {
+        const size_t size = _parents.size();
+        m_root = _root;
+        m_parent = _parents;
+        m_first_child.assign(size, NONE);
+        m_next_sibling.assign(size, NONE);
+        // Prepend in decreasing order, so the children end up in increasing order
+        for (VertexIdx v = static_cast<VertexIdx>(size) - 1; v >= 0; v--)
+        {
+            const VertexIdx parent = m_parent[v];
+            if (parent == NONE) continue;
+            m_next_sibling[v] = m_first_child[parent];
+            m_first_child[parent] = v;
+        }
+        UpdateOrder();
+        UpdateProperties();
+    }
+
+    //--------------------------------------------------------------
+    void ITree::UpdateOrder()
+    {
+        m_order.clear();
+        m_order.reserve(m_parent.size());
+        VertexIdx v = m_root;
+        while (v != NONE)
+        {
+            m_order.push_back(v);
+            if (m_first_child[v] != NONE)
+            {
+                v = m_first_child[v];
+                continue;
+            }
+            // Climb until there is a sibling left to visit
+            while (v != m_root && m_next_sibling[v] == NONE) v = m_parent[v];
+            v = v == m_root ? NONE : m_next_sibling[v];
+        }
+    }
+
     //--------------------------------------------------------------
     // Properties
     //--------------------------------------------------------------
-    uint ITree::Leaves(std::shared_ptr<TreeNode> node)
+    uint ITree::Leaves(VertexIdx _v) const
     {
-        uint leaves = 0;
-        if (node->children.size() == 0) leaves++;
-        for (auto& child : node->children) leaves += Leaves(child);
-        return leaves;
+        return m_subtree_leaves[_v];
     }
 
     //--------------------------------------------------------------
-    uint ITree::Depth(std::shared_ptr<TreeNode> node)
+    uint ITree::Depth(VertexIdx _v) const
     {
-        uint max = 0;
-        for (const auto& child : node->children)
+        return m_subtree_depth[_v];
+    }
+
+    //--------------------------------------------------------------
+    void ITree::UpdateSubtree(VertexIdx _v)
+    {
+        uint leaves = 0, max = 0;
+        for (VertexIdx child = m_first_child[_v]; child != NONE; child = m_next_sibling[child])
         {
-            const uint child_depth = Depth(child);
-            if (child_depth > max) max = child_depth;
+            leaves += m_subtree_leaves[child];
+            if (m_subtree_depth[child] > max) max = m_subtree_depth[child];
         }
-        return max + 1;
+        m_subtree_leaves[_v] = m_first_child[_v] == NONE ? 1 : leaves;
+        m_subtree_depth[_v] = max + 1;
     }
 
     //--------------------------------------------------------------
-    void ITree::SwapRoot(std::shared_ptr<TreeNode> _new_root)
+    void ITree::SwapRoot(VertexIdx _new_root)
     {
-        std::shared_ptr<TreeNode> node = _new_root;
-        while (node->GetVertexIdx() != m_root->GetVertexIdx())
+        // Path from the new root up to the old root
+        std::vector<VertexIdx> path;
+        for (VertexIdx v = _new_root; v != NONE; v = m_parent[v])
+            path.push_back(v);
+
+        for (size_t i = 0; i + 1 < path.size(); i++)
         {
-            node->children.push_back(node->parent);
-            auto& parent_children = node->parent->children;
-            for (int i = 0; i < parent_children.size(); i++)
+            const VertexIdx node = path[i], parent = path[i + 1];
+            // Unlink the node from the children of its parent
+            if (m_first_child[parent] == node)
+                m_first_child[parent] = m_next_sibling[node];
+            else
             {
-                if (parent_children[i] == node)
-                {
-                    // Replace node with final element
-                    parent_children[i] = parent_children[parent_children.size() - 1];
-                    parent_children.resize(parent_children.size() - 1);
-                    break;
-                }
+                VertexIdx sibling = m_first_child[parent];
+                while (m_next_sibling[sibling] != node) sibling = m_next_sibling[sibling];
+                m_next_sibling[sibling] = m_next_sibling[node];
             }
-            // Move to next node
-            node = node->parent;
         }
-
-        node = _new_root;
-        std::shared_ptr<TreeNode> prev = nullptr;
-        while (node != nullptr)
+        for (size_t i = 0; i + 1 < path.size(); i++)
         {
-            const auto next = node->parent;
-            node->parent = prev;
-            prev = node;
-            node = next;
+            const VertexIdx node = path[i], parent = path[i + 1];
+            // The parent becomes the last child of the node, it left its own siblings above
+            m_parent[parent] = node;
+            m_next_sibling[parent] = NONE;
+            if (m_first_child[node] == NONE)
+                m_first_child[node] = parent;
+            else
+            {
+                VertexIdx last = m_first_child[node];
+                while (m_next_sibling[last] != NONE) last = m_next_sibling[last];
+                m_next_sibling[last] = parent;
+            }
         }
-
+        m_parent[_new_root] = NONE;
+        m_next_sibling[_new_root] = NONE;
         m_root = _new_root;
-        UpdateProperties();
+
+        // The old root is now the deepest vertex on the path, the subtrees hanging off the path are unchanged
+        for (auto it = path.rbegin(); it != path.rend(); ++it)
+            UpdateSubtree(*it);
+        UpdateOrder();
+
+        leaves = m_subtree_leaves[m_root];
+        depth = m_subtree_depth[m_root];
     }
 
     //--------------------------------------------------------------
     void ITree::UpdateProperties()
     {
-        leaves = Leaves(m_root);
-        depth = Depth(m_root);
+        const size_t size = m_parent.size();
+        m_subtree_leaves.assign(size, 0);
+        m_subtree_depth.assign(size, 1);
+        // Reversed, every child is done before it is added to its parent
+        for (auto it = m_order.rbegin(); it != m_order.rend(); ++it)
+        {
+            const VertexIdx v = *it;
+            if (m_subtree_leaves[v] == 0) m_subtree_leaves[v] = 1;
+            const VertexIdx parent = m_parent[v];
+            if (parent == NONE) continue;
+            m_subtree_leaves[parent] += m_subtree_leaves[v];
+            m_subtree_depth[parent] = std::max(m_subtree_depth[parent], m_subtree_depth[v] + 1);
+        }
+
+        leaves = m_subtree_leaves[m_root];
+        depth = m_subtree_depth[m_root];
     }
 
     //--------------------------------------------------------------
@@ -85,25 +178,22 @@ namespace DataVis
         ofSetDrawBitmapMode(OF_BITMAPMODE_SIMPLE);
 
         // Draw vertices and edges
+        const auto& root = nodes[m_root];
         ofFill();
         ofSetColor(255, 0, 0);
-        ofDrawCircle(m_root->GetPosition(), m_root->GetRadius());
-        ofDrawBitmapStringHighlight(ofToString(m_root->GetVertexId()), m_root->GetPosition() + glm::vec3(10, 10, -1));
-
-        std::stack<std::shared_ptr<TreeNode>> stack;
-        for (auto& child : m_root->children) stack.push(child);
+        ofDrawCircle(root->GetPosition(), root->GetRadius());
+        ofDrawBitmapStringHighlight(ofToString(root->GetVertexId()), root->GetPosition() + glm::vec3(10, 10, -1));
 
-        while (stack.empty() == false)
+        static const glm::vec3 sub = {0, 0, -1}; // To draw edge behind vertices
+        const ofColor edge_color = ImGuiExtensions::Vec4ToOfColor(m_gui_data.coloredit_edge_color);
+        for (size_t i = 1; i < m_order.size(); i++)
         {
-            const auto& node = stack.top();
-            stack.pop();
-            const auto& parent = node->parent;
-            static const glm::vec3 sub = {0, 0, -1}; // To draw edge behind vertices
+            auto& node = *nodes[m_order[i]];
+            auto& parent = *nodes[m_parent[m_order[i]]];
             ofFill();
-            ofSetColor(ImGuiExtensions::Vec4ToOfColor(m_gui_data.coloredit_edge_color));
-            ofDrawLine(parent->GetPosition() + sub, node->GetPosition() + sub);
-            node->Draw();
-            for (auto& child : node->children) stack.push(child);
+            ofSetColor(edge_color);
+            ofDrawLine(parent.GetPosition() + sub, node.GetPosition() + sub);
+            node.Draw();
         }
     }
 
@@ -120,7 +210,7 @@ namespace DataVis
 
             if (ImGui::Button("Make root"))
             {
-                SwapRoot(std::static_pointer_cast<TreeNode>(m_selected_node));
+                SwapRoot(m_selected_node->GetVertexIdx());
             }
 
             ImGui::EndChild();
@@ -143,73 +233,166 @@ namespace DataVis
     void MSP::Create(VertexIdx _root)
     {
         const auto& vertices = dataset->vertices;
+        const auto& adjacency = dataset->GetAdjacency();
+
+        std::vector<float> weights(dataset->edges.size());
+        for (size_t e = 0; e < weights.size(); e++)
+            weights[e] = dataset->edges[e].attributes.FindFloat("weight", 1);
+        const auto parents = algorithm == Algorithm::Boruvka ? Boruvka(adjacency, weights, _root) : Prim(adjacency, weights, _root);
 
+        for (size_t i = 0; i < vertices.size(); i++)
+            nodes[i] = std::make_shared<Node>(vertices[i]->id, i);
+        BuildTopology(parents, _root);
+
+        // Update
+        UpdateAABB();
+        UpdateEdges();
+    }
+
+    //--------------------------------------------------------------
+    std::vector<VertexIdx> MSP::Prim(const Adjacency& _adjacency, const std::vector<float>& _weights, VertexIdx _root)
+    {
+        const int size = static_cast<int>(_adjacency.Size());
         // Keep track of the parent of each vertex so we can construct a tree after
-        std::vector<VertexIdx> parents(vertices.size(), 0);
+        std::vector<VertexIdx> parents(size, _root);
         parents[_root] = -1;
         // Keep track of which vertex are already processed
-        std::vector<bool> included(vertices.size(), false);
+        std::vector<bool> included(size, false);
         // Keep track of the minimum edge cost of a vertex
-        std::vector<float> costs(vertices.size(), MAX_FLOAT);
-        costs[_root] = 0;
+        std::vector<float> costs(size, MAX_FLOAT);
 
-        // Graph will have |vertices| vertices
-        for (size_t i = 0; i < vertices.size(); i++)
+        // Min heap of <cost, vertex>, an entry is stale once its vertex is included or got cheaper.
+        // Ties pop the lowest vertex, like a linear argmin over the costs
+        using Entry = std::pair<float, VertexIdx>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+        for (VertexIdx start = 0, next = _root; next < size; )
         {
-            // Argmin for costs
-            float min = MAX_FLOAT;
-            int idx = -1;
-            for (int v = 0; v < vertices.size(); v++)
+            costs[next] = 0;
+            heap.emplace(0.f, next);
+            while (!heap.empty())
             {
-                if (!included[v] && costs[v] < min)
+                const auto [cost, idx] = heap.top();
+                heap.pop();
+                if (included[idx] || cost != costs[idx]) continue;
+                included[idx] = true;
+
+                // Update outgoing edges from this vertex
+                for (const Neighbor neighbor : _adjacency.Outgoing(idx))
                 {
-                    min = costs[v];
-                    idx = v;
+                    const VertexIdx v = neighbor.idx;
+                    const float weight = _weights[neighbor.edge_idx];
+                    if (!included[v] && weight < costs[v])
+                    {
+                        // Found a cheaper edge to v
+                        parents[v] = idx;
+                        costs[v] = weight;
+                        heap.emplace(weight, v);
+                    }
                 }
             }
+            // The next tree starts at the lowest vertex not reached yet, it keeps the root as parent
+            while (start < size && included[start]) start++;
+            next = start;
+            if (next < size) parents[next] = _root;
+        }
+        return parents;
+    }
 
-            // Add lowest vertex
-            assert(idx != -1);
-            included[idx] = true;
+    //--------------------------------------------------------------
+    std::vector<VertexIdx> MSP::Boruvka(const Adjacency& _adjacency, const std::vector<float>& _weights, VertexIdx _root)
+    {
+        const int size = static_cast<int>(_adjacency.Size());
 
-            // Update outgoing edges from this vertex
-            for (const auto& neigbor : vertices[idx]->outgoing_neighbors)
+        // Union find over the components, only merged between the parallel steps
+        std::vector<VertexIdx> component(size);
+        std::iota(component.begin(), component.end(), 0);
+        auto find = [&](VertexIdx _v)
+        {
+            while (component[_v] != _v) _v = component[_v];
+            return _v;
+        };
+
+        struct Candidate
+        {
+            float weight = MAX_FLOAT;
+            EdgeIdx edge = std::numeric_limits<EdgeIdx>::max();
+            VertexIdx from = -1, to = -1;
+            bool operator<(const Candidate& _other) const
             {
-                const uint v = neigbor.idx;
-                const float weight = dataset->edges[neigbor.edge_idx].attributes.FindFloat("weight", 1);
-                if (!included[v] && weight < costs[v])
+                return weight < _other.weight || (weight == _other.weight && edge < _other.edge);
+            }
+        };
+
+        std::vector<bool> in_tree(_weights.size(), false);
+        std::vector<Candidate> vertex_best(size), component_best(size);
+        bool merged = true;
+        while (merged)
+        {
+            // Flatten the components, every vertex points to its representative
+            ThreadPool::Global().ParallelFor(0, size, [&](int _v) { vertex_best[_v] = Candidate(); });
+            for (VertexIdx v = 0; v < size; v++)
+                component[v] = find(v);
+
+            // Cheapest edge leaving the component per vertex, in both directions
+            ThreadPool::Global().ParallelFor(0, size, [&](int _v)
+            {
+                Candidate& best = vertex_best[_v];
+                auto consider = [&](const Neighbor& _neighbor)
                 {
-                    // Found a cheaper edge to v
-                    parents[v] = idx;
-                    costs[v] = weight;
-                }
+                    if (component[_neighbor.idx] == component[_v]) return;
+                    const Candidate candidate = { _weights[_neighbor.edge_idx], _neighbor.edge_idx, _v, _neighbor.idx };
+                    if (candidate < best) best = candidate;
+                };
+                for (const Neighbor neighbor : _adjacency.Outgoing(_v)) consider(neighbor);
+                for (const Neighbor neighbor : _adjacency.Incoming(_v)) consider(neighbor);
+            });
+
+            // Cheapest edge per component, then merge along them
+            std::fill(component_best.begin(), component_best.end(), Candidate());
+            for (VertexIdx v = 0; v < size; v++)
+            {
+                if (vertex_best[v] < component_best[component[v]])
+                    component_best[component[v]] = vertex_best[v];
+            }
+            merged = false;
+            for (VertexIdx c = 0; c < size; c++)
+            {
+                const Candidate& best = component_best[c];
+                if (best.from < 0) continue;
+                const VertexIdx a = find(best.from), b = find(best.to);
+                if (a == b) continue;
+                component[std::max(a, b)] = std::min(a, b);
+                in_tree[best.edge] = true;
+                merged = true;
             }
         }
 
-        // Construct a tree
-        m_root = std::make_shared<ITree::TreeNode>(vertices[_root]->id, _root);
-        nodes[_root] = m_root;
-
-        // Construct recursive lambda to create the tree
-        static std::function<void(const std::shared_ptr<ITree::TreeNode>&, VectorOfNodes&)> make_tree =
-            [&](const std::shared_ptr<ITree::TreeNode>& n, VectorOfNodes& nodes)
+        // Root the forest, breadth first from the root and then from the lowest vertex of every other tree
+        std::vector<VertexIdx> parents(size, -2);
+        std::queue<VertexIdx> queue;
+        auto visit = [&](VertexIdx _start, VertexIdx _parent)
         {
-            // Look through all vertices which have parent == n.vertex
-            for (size_t i = 0; i < vertices.size(); i++)
-                if (parents[i] == n->GetVertexIdx())
+            parents[_start] = _parent;
+            queue.push(_start);
+            while (!queue.empty())
+            {
+                const VertexIdx u = queue.front();
+                queue.pop();
+                auto follow = [&](const Neighbor& _neighbor)
                 {
-                    // Add node to n.children
-                    auto child = std::make_shared<ITree::TreeNode>(vertices[i]->id, i, n);
-                    nodes[i] = child;
-                    n->children.push_back(child);
-                    make_tree(child, nodes);
-                }
+                    if (!in_tree[_neighbor.edge_idx] || parents[_neighbor.idx] != -2) return;
+                    parents[_neighbor.idx] = u;
+                    queue.push(_neighbor.idx);
+                };
+                for (const Neighbor neighbor : _adjacency.Outgoing(u)) follow(neighbor);
+                for (const Neighbor neighbor : _adjacency.Incoming(u)) follow(neighbor);
+            }
         };
-        make_tree(m_root, nodes);
-        
-        // Update
-        UpdateProperties();
-        UpdateAABB();
-        UpdateEdges();
+        visit(_root, -1);
+        for (VertexIdx v = 0; v < size; v++)
+        {
+            if (parents[v] == -2) visit(v, _root);
+        }
+        return parents;
     }
 } // DataVis
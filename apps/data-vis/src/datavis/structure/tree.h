@@ -12,28 +12,25 @@ public:
 		float input_radial_delta_angle = 100;
 	} m_imgui_data;
 
-	class TreeNode : public Node
-	{
-	public:
-		TreeNode(std::string _vertex_id, VertexIdx _vertex_index, std::shared_ptr<TreeNode> _parent = nullptr, const glm::vec3& _current_position = glm::vec3(0))
-			: Node(_vertex_id, _vertex_index, _current_position)
-		{
-			parent = _parent;
-		}
-
-		std::shared_ptr<TreeNode> parent;
-		std::vector<std::shared_ptr<TreeNode>> children;
-	};
-
 	//--------------------------------------------------------------
 	ITree() = default;
 	void Init(const std::shared_ptr<Dataset>) = 0;
 
 	//--------------------------------------------------------------
-	std::shared_ptr<TreeNode> Root();
-	static uint Leaves(std::shared_ptr<TreeNode>);
-	static uint Depth(std::shared_ptr<TreeNode>);
-	void SwapRoot(std::shared_ptr<TreeNode>);
+	// The topology is kept in flat arrays indexed by vertex, NONE where there is no such vertex.
+	// The children of a node are linked from its first child through the next siblings
+	static constexpr VertexIdx NONE = -1;
+	[[nodiscard]] VertexIdx Root() const;
+	[[nodiscard]] VertexIdx Parent(VertexIdx) const;
+	[[nodiscard]] VertexIdx FirstChild(VertexIdx) const;
+	[[nodiscard]] VertexIdx NextSibling(VertexIdx) const;
+	// Every vertex in depth first pre-order from the root, parents before their children
+	[[nodiscard]] const std::vector<VertexIdx>& Order() const;
+	// Leaves and levels of the subtree below a vertex, cached
+	[[nodiscard]] uint Leaves(VertexIdx) const;
+	[[nodiscard]] uint Depth(VertexIdx) const;
+	// Only the vertices on the path to the old root get their subtree properties recomputed
+	void SwapRoot(VertexIdx);
 
 	float speed = 5;
 
@@ -44,16 +41,42 @@ protected:
 	void DrawNodes() override;
 	void NodeInfoGui() override;
 
+	// Topology from the parent of every vertex, NONE for the root. The children are linked in increasing vertex order
+	void BuildTopology(const std::vector<VertexIdx>& parents, VertexIdx root);
+	// Depth first order by following the links, no stack needed
+	void UpdateOrder();
+	// Subtree properties of every vertex in one pass over the reversed order
 	void UpdateProperties();
-	std::shared_ptr<TreeNode> m_root;
+	// Subtree properties of a single vertex from those of its children
+	void UpdateSubtree(VertexIdx);
+
+	VertexIdx m_root = NONE;
+	std::vector<VertexIdx> m_parent;
+	std::vector<VertexIdx> m_first_child;
+	std::vector<VertexIdx> m_next_sibling;
+	std::vector<VertexIdx> m_order;
+	std::vector<uint> m_subtree_leaves;
+	std::vector<uint> m_subtree_depth;
 };
 
 // Prim's Algorithm https://en.wikipedia.org/wiki/Prim%27s_algorithm
 class MSP : public ITree
 {
 public:
+	enum class Algorithm { Prim, Boruvka };
+
 	void Init(const std::shared_ptr<Dataset>) override;
 
+	// Parent of every vertex, -1 for the root. Follows the outgoing edges, vertices the root
+	// does not reach hang from it in trees of their own
+	static std::vector<VertexIdx> Prim(const Adjacency&, const std::vector<float>& weights, VertexIdx root);
+	// Minimum spanning forest with the edges undirected, rooted like Prim. The components pick their
+	// cheapest edge in parallel every round, ties go to the lowest edge index
+	static std::vector<VertexIdx> Boruvka(const Adjacency&, const std::vector<float>& weights, VertexIdx root);
+
+	// Set before Init
+	Algorithm algorithm = Algorithm::Prim;
+
 private:
 	void Create(VertexIdx _root);
 };
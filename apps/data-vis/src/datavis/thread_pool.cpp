@@ -0,0 +1,110 @@
+#include "precomp.h"
+
+namespace DataVis
+{
+//--------------------------------------------------------------
+// Thread Pool
+//--------------------------------------------------------------
+ThreadPool::ThreadPool(uint _threads)
+{
+    _threads = std::max(1u, _threads);
+    m_threads.reserve(_threads);
+    for (uint i = 0; i < _threads; i++)
+        m_threads.emplace_back(&ThreadPool::Worker, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_all();
+    for (auto& thread : m_threads)
+        thread.join();
+}
+
+ThreadPool& ThreadPool::Global()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+uint ThreadPool::Size() const
+{
+    return m_threads.size();
+}
+
+//--------------------------------------------------------------
+void ThreadPool::Enqueue(std::function<void()> _task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(_task));
+    }
+    m_condition.notify_one();
+}
+
+//--------------------------------------------------------------
+void ThreadPool::Worker()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+            if (m_stop && m_tasks.empty()) return;
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        task();
+    }
+}
+
+//--------------------------------------------------------------
+void ThreadPool::ParallelFor(int _begin, int _end, const std::function<void(int)>& _f, uint _max_threads)
+{
+    if (_end <= _begin) return;
+
+    struct State
+    {
+        std::atomic<int> next;
+        std::atomic<int> done{0};
+        int end;
+        std::function<void(int)> f;
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto state = std::make_shared<State>();
+    state->next = _begin;
+    state->end = _end;
+    state->f = _f;
+    const int count = _end - _begin;
+
+    // Every participant pulls indices until the range is exhausted
+    auto work = [state, count]()
+    {
+        int i;
+        while ((i = state->next++) < state->end)
+        {
+            state->f(i);
+            if (++state->done == count)
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->finished.notify_all();
+            }
+        }
+    };
+
+    uint threads = _max_threads == 0 ? Size() : std::min(_max_threads, Size());
+    threads = std::min<uint>(threads, count);
+    // The calling thread is one of the participants
+    for (uint t = 1; t < threads; t++)
+        Enqueue(work);
+    work();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&]() { return state->done == count; });
+}
+} // namespace DataVis
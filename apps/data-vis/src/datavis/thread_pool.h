@@ -0,0 +1,48 @@
+#pragma once
+
+namespace DataVis
+{
+//--------------------------------------------------------------
+// Thread Pool
+//--------------------------------------------------------------
+class ThreadPool
+{
+public:
+    explicit ThreadPool(uint threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// Shared pool used by the layouts and metrics
+    static ThreadPool& Global();
+
+    [[nodiscard]] uint Size() const;
+
+    template <typename F>
+    auto Submit(F&& task) -> std::future<std::invoke_result_t<F>>
+    {
+        using Result = std::invoke_result_t<F>;
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> future = packaged->get_future();
+        Enqueue([packaged]() { (*packaged)(); });
+        return future;
+    }
+
+    /**
+     * \brief Calls f(i) for every i in [begin, end) spread over the pool.
+     * The calling thread takes part in the work, so it is safe to call from inside a pool task.
+     * \param max_threads 0 uses every thread in the pool
+     */
+    void ParallelFor(int begin, int end, const std::function<void(int)>& f, uint max_threads = 0);
+
+private:
+    void Enqueue(std::function<void()> task);
+    void Worker();
+
+    std::vector<std::thread> m_threads;
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stop = false;
+};
+} // namespace DataVis
@@ -2,8 +2,12 @@
 #include "ofApp.h"
 
 // ========================================================================
-int main()
+int main(int argc, char* argv[])
 {
+	// Self checks without a window or datasets, the exit code tells whether they passed
+	if (argc > 1 && std::string(argv[1]) == "--check")
+		return DataVis::Benchmark::CrossingMetricCheck(1) ? 0 : 1;
+
 	ofGLFWWindowSettings settings;
 	settings.setSize(800, 600);
 	settings.setGLVersion(3, 3);
@@ -25,8 +25,8 @@ void ofApp::setup()
     m_camera.setFarClip(1e30);
     m_camera.setGlobalPosition(glm::vec3(0, 0, 2500));
     
-    // Load
-    LoadDotFiles();
+    // Only registers the files, the datasets load in the background
+    m_datasets.Scan();
 
     m_factories.emplace_back("Graph",
                              [](std::shared_ptr<Dataset> _dataset)
@@ -44,6 +44,15 @@ void ofApp::setup()
                                  RandomLayout::Apply(*m, 800, 800);
                                  return m;
                              });
+    m_factories.emplace_back("MSP Tree (Boruvka)",
+                             [](std::shared_ptr<Dataset> _dataset)
+                             {
+                                 auto m = make_shared<MSP>();
+                                 m->algorithm = MSP::Algorithm::Boruvka;
+                                 m->Init(_dataset);
+                                 RandomLayout::Apply(*m, 800, 800);
+                                 return m;
+                             });
 	m_factories.emplace_back("Clusters",
                              [](std::shared_ptr<Dataset> _dataset)
                              {
@@ -53,29 +62,6 @@ void ofApp::setup()
                              });
 }
 
-//--------------------------------------------------------------
-void ofApp::LoadDotFiles()
-{
-    const std::string data_path = ofToDataPath("", false);
-    for (const auto& entry : filesystem::directory_iterator(data_path))
-    {
-        if (entry.path().extension() == ".dot")
-        {
-            std::string filename = entry.path().filename().string();
-            m_graph_file_names.push_back(filename);
-            if (Model::MainGraph graph; DataVis::Parser::DotFile(filename, graph))
-            {
-                auto dataset = std::make_unique<DataVis::Dataset>();
-                if (!graph.graph.subgraphs.empty())
-                    dataset = std::make_unique<DataVis::ClusterDataset>();
-                dataset->Load(graph, filename);
-                m_datasets.push_back(std::move(dataset));
-            }
-        }
-    }
-    m_current_graph_file = m_graph_file_names[m_imgui_data.combo_graph_file_index];
-}
-
 //--------------------------------------------------------------
 void ofApp::update()
 {
@@ -131,23 +117,33 @@ void ofApp::Gui()
         //--------------------------------------------------------------
         // Create IStructure 
         //--------------------------------------------------------------
-        if (!m_datasets.empty())
+        if (!m_datasets.Empty())
         {
             if (ImGui::BeginMenu("Create"))
             {
-                const char* select_dataset_preview = m_datasets[m_imgui_data.combo_dataset_index]->GetFilename().c_str();
-                if (ImGui::BeginCombo("Select Dataset", select_dataset_preview))
+                auto label = [&](size_t _i)
+                {
+                    const auto state = m_datasets.GetState(_i);
+                    if (state == DatasetLoader::State::Loading) return m_datasets.GetFilename(_i) + " (loading)";
+                    if (state == DatasetLoader::State::Failed) return m_datasets.GetFilename(_i) + " (failed)";
+                    return m_datasets.GetFilename(_i);
+                };
+                m_imgui_data.combo_dataset_index = std::min<int>(m_imgui_data.combo_dataset_index, m_datasets.Size() - 1);
+                const std::string select_dataset_preview = label(m_imgui_data.combo_dataset_index);
+                if (ImGui::BeginCombo("Select Dataset", select_dataset_preview.c_str()))
                 {
-                    for (int n = 0; n < m_datasets.size(); n++)
+                    for (int n = 0; n < m_datasets.Size(); n++)
                     {
                         const bool is_selected = (m_imgui_data.combo_dataset_index == n);
-                        if (ImGui::Selectable(m_datasets[n]->GetFilename().c_str(), is_selected))
+                        if (ImGui::Selectable(label(n).c_str(), is_selected))
                             m_imgui_data.combo_dataset_index = n;
                         if (is_selected)
                             ImGui::SetItemDefaultFocus();
                     }
                     ImGui::EndCombo();
                 }
+                if (const size_t loaded = m_datasets.LoadedCount(); loaded < m_datasets.Size())
+                    ImGui::TextDisabled("Loading datasets %zu/%zu", loaded, m_datasets.Size());
 
                 const char* select_structure_preview = m_factories[m_imgui_data.combo_structure_index].first.c_str();
                 if (ImGui::BeginCombo("Select Structure", select_structure_preview))
@@ -163,18 +159,62 @@ void ofApp::Gui()
                     ImGui::EndCombo();
                 }
 
+                // Waits for the selected dataset when it is still loading
                 if (ImGui::Button("Create Structure"))
                 {
-                    auto new_dataset_file = m_datasets[m_imgui_data.combo_dataset_index];
-                    auto factory = m_factories[m_imgui_data.combo_structure_index].second;
-                    auto structure = factory(new_dataset_file);
-                    structure->SetOnDeleteCallback(std::bind(&ofApp::DeleteStructure, this, std::placeholders::_1));
-                    m_structures.push_back(std::move(structure));
+                    if (auto new_dataset_file = m_datasets.Get(m_imgui_data.combo_dataset_index))
+                    {
+                        auto factory = m_factories[m_imgui_data.combo_structure_index].second;
+                        auto structure = factory(new_dataset_file);
+                        structure->SetOnDeleteCallback(std::bind(&ofApp::DeleteStructure, this, std::placeholders::_1));
+                        m_structures.push_back(std::move(structure));
+                    }
                 }
                 ImGui::EndMenu();
             }
         }
 
+#ifdef DATAVIS_BENCHMARKS
+        //--------------------------------------------------------------
+        // Benchmarks, results are printed to the console
+        //--------------------------------------------------------------
+        // Benchmarks wait for every dataset to load
+        if (!m_datasets.Empty() && ImGui::BeginMenu("Benchmark"))
+        {
+            if (ImGui::MenuItem("All Pairs Shortest Paths"))
+                Benchmark::AllPairsShortestPaths(m_datasets.GetAll());
+            if (ImGui::MenuItem("Force Directed"))
+                Benchmark::ForceDirected(m_datasets.GetAll());
+            if (ImGui::MenuItem("DOT Parsers"))
+                Benchmark::DotParsers(m_datasets.GetFilenames());
+            if (ImGui::MenuItem("Snapshots"))
+                Benchmark::Snapshots(m_datasets.GetFilenames());
+            if (ImGui::MenuItem("Bilayer Crossings"))
+                Benchmark::BilayerCrossings(m_datasets.GetAll());
+            if (ImGui::MenuItem("Cycle Breaking"))
+                Benchmark::CycleBreaking();
+            if (ImGui::MenuItem("Layering"))
+                Benchmark::Layering(m_datasets.GetAll());
+            if (ImGui::MenuItem("Crossing Minimization"))
+                Benchmark::CrossingMinimization(m_datasets.GetAll());
+            if (ImGui::MenuItem("Vertex Positioning"))
+                Benchmark::VertexPositioning(m_datasets.GetAll());
+            if (ImGui::MenuItem("Crossing Metric"))
+                Benchmark::CrossingMetric(m_datasets.GetAll());
+            if (ImGui::MenuItem("Neighborhood Preservation"))
+                Benchmark::NeighborhoodPreservation(m_datasets.GetAll());
+            if (ImGui::MenuItem("Minimum Spanning Tree"))
+                Benchmark::MinimumSpanningTree(m_datasets.GetAll());
+            if (ImGui::MenuItem("Radial Tree"))
+                Benchmark::RadialTree(m_datasets.GetAll());
+            if (ImGui::MenuItem("Cluster Frames"))
+                Benchmark::ClusterFrames(m_datasets.GetAll());
+            if (ImGui::MenuItem("Edge Updates"))
+                Benchmark::EdgeUpdates(m_datasets.GetAll());
+            ImGui::EndMenu();
+        }
+#endif // DATAVIS_BENCHMARKS
+
         ImGui::EndMainMenuBar();
     }
 
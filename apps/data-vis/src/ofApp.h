@@ -7,7 +7,6 @@ class ofApp : public ofBaseApp {
 private:
 	struct ImGuiData
 	{
-		int combo_graph_file_index = 1;
 		int combo_dataset_index = 4;
 		int combo_structure_index = 0;
 		int combo_layout_function_index = 0;
@@ -16,19 +15,15 @@ private:
 	std::vector<std::pair<std::string, std::function<std::shared_ptr<IStructure>(std::shared_ptr<Dataset>)>>> m_factories;
 
 	std::vector<std::shared_ptr<DataVis::IStructure>> m_structures;
-	std::vector<std::shared_ptr<DataVis::Dataset>> m_datasets;
+	DataVis::DatasetLoader m_datasets;
 
 	ofEasyCam m_camera;
 
-	std::vector<string> m_graph_file_names;
-	std::string m_current_graph_file = "";
-
 	glm::vec2 m_prev_mouse_drag = glm::vec2(1e30);
 	
 	std::shared_ptr<DataVis::IStructure> m_focussed_structure = nullptr;
 	std::shared_ptr<DataVis::IStructure> m_dragging_structure = nullptr;
 
-	void LoadDotFiles();
 	glm::vec3 ScreenToWorld(const glm::vec2& pos);
 
 public:
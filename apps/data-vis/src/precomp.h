@@ -14,6 +14,8 @@
 #include <boost/exception/exception.hpp>
 #include <boost/exception/diagnostic_information.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 
 //--------------------------------------------------------------
 // OF header
@@ -42,7 +44,19 @@ namespace Color
 #include <iostream>
 #include <deque>
 #include <variant>
+#include <optional>
 #include <limits.h>
+#include <chrono>
+#include <queue>
+#include <thread>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <numeric>
+#include <string_view>
+#include <unordered_map>
+#include <set>
 
 //--------------------------------------------------------------
 typedef unsigned int uint;
@@ -90,6 +104,15 @@ namespace DataVis
     {
         float Cross(const glm::vec2& p, const glm::vec2& q);
     }
+
+    // Wall clock timer, starts on construction
+    struct Timer
+    {
+        Timer();
+        void Reset();
+        [[nodiscard]] float ElapsedMs() const;
+        std::chrono::steady_clock::time_point start;
+    };
 } // namespace DataVis
 
 //--------------------------------------------------------------
@@ -104,10 +127,18 @@ namespace DataVis
 
 //--------------------------------------------------------------
 // Own headers
+#include "thread_pool.h"
 #include "dataset.h"
+#include "dot_parser.h"
+#include "snapshot.h"
+#include "dataset_loader.h"
 #include "floyd_warshall.h"
+#include "shortest_paths.h"
+#include "distance_cache.h"
 #include "animator.h"
 #include "aabb.h"
+#include "quadtree.h"
+#include "kd_tree.h"
 #include "structure/node.h"
 #include "structure/edge_path.h"
 #include "structure/structure.h"
@@ -115,4 +146,8 @@ namespace DataVis
 #include "structure/tree.h"
 #include "structure/clusters.h"
 #include "layout/quality_metrics.h"
+#include "layout/layout_job.h"
 #include "layout/layout.h"
+// The Benchmark menu and the reference implementations it checks the kernels against, off in regular builds
+// #define DATAVIS_BENCHMARKS
+#include "benchmark.h"
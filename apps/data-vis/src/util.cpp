@@ -82,4 +82,20 @@ float Cross(const glm::vec2& p, const glm::vec2& q)
 	return p.x * q.y - p.y * q.x;
 }
 }
+
+//--------------------------------------------------------------
+Timer::Timer()
+{
+	Reset();
+}
+
+void Timer::Reset()
+{
+	start = std::chrono::steady_clock::now();
+}
+
+float Timer::ElapsedMs() const
+{
+	return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
 } // namespace DataVis